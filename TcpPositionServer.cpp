@@ -1,21 +1,23 @@
 #include "TcpPositionServer.hpp"
 #include <iostream>
+#include <cerrno>
 #include <cstring>
+#include <stdexcept>
 #include <vector>
 #include <fcntl.h>
+#include <poll.h>
 
-TcpPositionServer::TcpPositionServer(int port) : seq_number_(0) {
+TcpPositionServer::TcpPositionServer(int port) : client_socket_(-1), seq_number_(0) {
     server_socket_ = socket(AF_INET, SOCK_STREAM, 0);
     if (server_socket_ < 0) {
-        std::cerr << "Failed to create server socket." << std::endl;
-        exit(1);
+        throw std::runtime_error(std::string("Failed to create server socket: ") + strerror(errno));
     }
 
+    // SO_REUSEADDR only allows a quick restart after TIME_WAIT; without SO_REUSEPORT a second
+    // simulation on the same port fails to bind instead of silently sharing it
     int opt = 1;
-    if (setsockopt(server_socket_, SOL_SOCKET, SO_REUSEADDR | SO_REUSEPORT,
-                   &opt, sizeof(opt)) < 0) {
-        std::cerr << "setsockopt failed" << std::endl;
-        exit(1);
+    if (setsockopt(server_socket_, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
+        Fail("setsockopt failed");
     }
 
     server_address_.sin_family = AF_INET;
@@ -23,26 +25,46 @@ TcpPositionServer::TcpPositionServer(int port) : seq_number_(0) {
     server_address_.sin_port = htons(port);
 
     if (bind(server_socket_, (struct sockaddr*)&server_address_, sizeof(server_address_)) < 0) {
-        std::cerr << "Failed to bind server socket." << std::endl;
-        exit(1);
+        Fail("Failed to bind server socket to port " + std::to_string(port));
     }
 
     if (listen(server_socket_, 1) < 0) {
-        std::cerr << "Listen failed." << std::endl;
-        exit(1);
+        Fail("Listen failed");
+    }
+
+    // The client is accepted later by acceptClient(), so the owner can finish its setup first
+}
+
+bool TcpPositionServer::acceptClient(int timeout_ms) {
+    if (client_socket_ >= 0) {
+        return true;
+    }
+    pollfd pfd{server_socket_, POLLIN, 0};
+    if (poll(&pfd, 1, timeout_ms) <= 0) {
+        return false;
     }
 
     client_addrlen_ = sizeof(client_address_);
     client_socket_ = accept(server_socket_, (struct sockaddr*)&client_address_, &client_addrlen_);
 
     if (client_socket_ < 0) {
-        std::cerr << "Failed to accept client connection." << std::endl;
-        exit(1);
+        // Transient (e.g. the client reset the connection first): the next call retries
+        std::cerr << "Failed to accept client connection: " << strerror(errno) << std::endl;
+        return false;
     }
 
     // Optionally set the client socket to non-blocking
     int flags = fcntl(client_socket_, F_GETFL, 0);
     fcntl(client_socket_, F_SETFL, flags | O_NONBLOCK);
+    return true;
+}
+
+void TcpPositionServer::Fail(const std::string& what) {
+    // The destructor does not run for a constructor that throws
+    std::string message = what + ": " + strerror(errno);
+    close(server_socket_);
+    server_socket_ = -1;
+    throw std::runtime_error(message);
 }
 
 TcpPositionServer::~TcpPositionServer() {
@@ -54,9 +76,9 @@ TcpPositionServer::~TcpPositionServer() {
     }
 }
 
-void TcpPositionServer::updatePositionOfUnit(int unit_id,
-                              const chrono::ChVector3<double>& position,
-                              const chrono::ChQuaternion<double>& rotation, TerrainSystemCoordinates &terrain_system) {
+static TwistSendable_t makeTwist(const chrono::ChVector3<double>& position,
+                                 const chrono::ChQuaternion<double>& rotation,
+                                 TerrainSystemCoordinates &terrain_system) {
     // Convert rotation quaternion to Euler angles (roll, pitch, yaw)
     double q0 = rotation.e0();  // scalar part
     double q1 = rotation.e1();
@@ -94,6 +116,15 @@ void TcpPositionServer::updatePositionOfUnit(int unit_id,
     twistData.roll = static_cast<float>(roll);
     twistData.pitch = static_cast<float>(pitch);
     twistData.yaw = static_cast<float>(yaw);
+    return twistData;
+}
+
+bool TcpPositionServer::sendPacket(PacketTypes_t type, int id, uint32_t seq, const void* data, uint32_t size,
+                                   bool wait) {
+    if (client_socket_ < 0) {
+        return false;
+    }
+
     // Get current timestamp in nanoseconds
     auto now = std::chrono::high_resolution_clock::now();
     int64_t timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
@@ -101,36 +132,111 @@ void TcpPositionServer::updatePositionOfUnit(int unit_id,
                                .count();
 
     // Calculate total packet size
-    uint32_t dataSize = sizeof(TwistSendable_t);
-    uint32_t packetSize = sizeof(SendablePacket_t) + dataSize;
+    uint32_t packetSize = sizeof(SendablePacket_t) + size;
 
     // Create a buffer to hold the packet
     std::vector<uint8_t> buffer(packetSize);
 
     // Fill in the packet header
     SendablePacket_t* packet = reinterpret_cast<SendablePacket_t*>(buffer.data());
-    packet->type = PacketTypes_t::UpdateUnitPositionPacket;
-    packet->id = unit_id;
-    packet->seq = seq_number_++;
-    packet->size = dataSize;
+    packet->type = type;
+    packet->id = id;
+    packet->seq = seq;
+    packet->size = size;
     packet->stamp = timestamp_ns;
 
-    // Copy the twist data into the packet data
-    memcpy(packet->data, &twistData, dataSize);
-
-    // Send the packet
-    ssize_t bytes_sent = send(client_socket_, buffer.data(), buffer.size(), 0);
-    if (bytes_sent < 0) {
-        if (errno == EAGAIN || errno == EWOULDBLOCK) {
-            // Non-blocking socket, no data sent this time
-            // Handle accordingly if needed
+    // Copy the payload into the packet data
+    memcpy(packet->data, data, size);
+
+    // Send the packet. Streamed poses may be dropped whole when the socket is full; lockstep
+    // replies must not be, so with wait set we block until the whole packet is out. Once any
+    // byte of a packet is on the wire the rest always follows, or the client loses framing.
+    size_t sent = 0;
+    while (sent < buffer.size()) {
+        ssize_t bytes_sent = send(client_socket_, buffer.data() + sent, buffer.size() - sent, MSG_NOSIGNAL);
+        if (bytes_sent >= 0) {
+            sent += bytes_sent;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+            if (!wait && sent == 0) {
+                // Socket full before the packet started: drop it whole
+                return true;
+            }
+            pollfd pfd{client_socket_, POLLOUT, 0};
+            poll(&pfd, 1, -1);
         } else {
             std::cerr << "Failed to send data to client: " << strerror(errno) << std::endl;
-            // Optionally handle disconnection
+            return false;
         }
-    } else {
-        // Data sent successfully
-        // Optionally, print debug information
-        // std::cout << "Sent " << bytes_sent << " bytes to client." << std::endl;
     }
-}
\ No newline at end of file
+    return true;
+}
+
+void TcpPositionServer::updatePositionOfUnit(int unit_id,
+                              const chrono::ChVector3<double>& position,
+                              const chrono::ChQuaternion<double>& rotation, TerrainSystemCoordinates &terrain_system) {
+    TwistSendable_t twistData = makeTwist(position, rotation, terrain_system);
+    sendPacket(PacketTypes_t::UpdateUnitPositionPacket, unit_id, seq_number_++, &twistData, sizeof(twistData), false);
+}
+
+TcpPositionServer::ReceiveStatus TcpPositionServer::pollPacket(SendablePacket_t& header,
+                                                               std::vector<uint8_t>& payload) {
+    if (client_socket_ < 0) {
+        return ReceiveStatus::Empty;
+    }
+
+    // Drain whatever the non-blocking socket has, then cut one packet off the front
+    uint8_t chunk[4096];
+    while (true) {
+        ssize_t n = recv(client_socket_, chunk, sizeof(chunk), 0);
+        if (n > 0) {
+            rx_buffer_.insert(rx_buffer_.end(), chunk, chunk + n);
+        } else if (n == 0) {
+            std::cerr << "Client disconnected." << std::endl;
+            return ReceiveStatus::Disconnected;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            break;
+        } else if (errno != EINTR) {
+            std::cerr << "Failed to receive data from client: " << strerror(errno) << std::endl;
+            return ReceiveStatus::Disconnected;
+        }
+    }
+
+    if (rx_buffer_.size() < sizeof(SendablePacket_t)) {
+        return ReceiveStatus::Empty;
+    }
+    memcpy(&header, rx_buffer_.data(), sizeof(header));
+    size_t total = sizeof(SendablePacket_t) + header.size;
+    if (rx_buffer_.size() < total) {
+        return ReceiveStatus::Empty;
+    }
+
+    payload.assign(rx_buffer_.begin() + sizeof(SendablePacket_t), rx_buffer_.begin() + total);
+    rx_buffer_.erase(rx_buffer_.begin(), rx_buffer_.begin() + total);
+    return ReceiveStatus::Packet;
+}
+
+TcpPositionServer::ReceiveStatus TcpPositionServer::receivePacket(SendablePacket_t& header,
+                                                                  std::vector<uint8_t>& payload, int timeout_ms) {
+    while (true) {
+        ReceiveStatus status = pollPacket(header, payload);
+        if (status != ReceiveStatus::Empty) {
+            return status;
+        }
+        pollfd pfd{client_socket_, POLLIN, 0};
+        if (poll(&pfd, 1, timeout_ms) == 0) {
+            return ReceiveStatus::Empty;
+        }
+    }
+}
+
+bool TcpPositionServer::sendStepResponse(int unit_id, uint32_t seq, uint64_t step, double time,
+                                         const chrono::ChVector3<double>& position,
+                                         const chrono::ChQuaternion<double>& rotation, double speed,
+                                         TerrainSystemCoordinates &terrain_system) {
+    StepResponseSendable_t response;
+    response.step = step;
+    response.time = time;
+    response.twist = makeTwist(position, rotation, terrain_system);
+    response.speed = static_cast<float>(speed);
+    return sendPacket(PacketTypes_t::StepResponsePacket, unit_id, seq, &response, sizeof(response), true);
+}
@@ -10,6 +10,8 @@
 
 // Include necessary headers
 #include <cstdint>
+#include <string>
+#include <vector>
 #include <chrono>
 
 // Use packed structures to match the client's expectations
@@ -20,6 +22,10 @@ enum class PacketTypes_t : uint8_t
     CreateUnitPacket = 1,
     UpdateUnitPositionPacket = 2,
     DeleteUnitPacket = 3,
+    StepRequestPacket = 4,
+    StepResponsePacket = 5,
+    SaveSnapshotPacket = 6,     // Lockstep: store the current state in slot `id`
+    RestoreSnapshotPacket = 7,  // Lockstep: return to the state stored in slot `id`
 };
 
 
@@ -33,6 +39,8 @@ struct TwistSendable_t
     float yaw;
 };
 
+// CreateUnit: spawn a vehicle with unit id `id` at this pose (UE coordinates, like UpdateUnitPosition).
+// DeleteUnit carries no payload and removes unit `id`.
 struct CreateUnitSendable_t
 {
     int type;
@@ -40,6 +48,24 @@ struct CreateUnitSendable_t
 };
 
 
+// Lockstep: the client asks for `steps` physics steps with these driver inputs held constant
+struct StepRequestSendable_t
+{
+    uint32_t steps;
+    float throttle;
+    float steering;
+    float braking;
+};
+
+// Lockstep: state after the requested steps, pose in UE coordinates like UpdateUnitPosition
+struct StepResponseSendable_t
+{
+    uint64_t step;
+    double time;
+    TwistSendable_t twist;
+    float speed;
+};
+
 struct SendablePacket_t
 {
     PacketTypes_t type;
@@ -59,13 +85,39 @@ private:
     socklen_t client_addrlen_;
     uint32_t seq_number_;  // Sequence number for packets
 
+    std::vector<uint8_t> rx_buffer_;  // Bytes received but not yet returned as a packet
+
+    bool sendPacket(PacketTypes_t type, int id, uint32_t seq, const void* data, uint32_t size, bool wait);
+    [[noreturn]] void Fail(const std::string& what);
+
 public:
+    // Binds and listens on the port; does not wait for the client. Throws std::runtime_error
+    // if the port cannot be bound.
     TcpPositionServer(int port);
     ~TcpPositionServer();
 
+    // Wait up to timeout_ms (-1 = forever) for the client to connect; true once connected.
+    // Until then packets are not sent and nothing is received.
+    bool acceptClient(int timeout_ms);
+    bool isConnected() const { return client_socket_ >= 0; }
+
     void updatePositionOfUnit(int unit_id,
                               const chrono::ChVector3<double>& position,
                               const chrono::ChQuaternion<double>& rotation, TerrainSystemCoordinates &terrain_system);
+
+    enum class ReceiveStatus { Packet, Empty, Disconnected };
+
+    // Return the next complete packet from the client without blocking
+    ReceiveStatus pollPacket(SendablePacket_t& header, std::vector<uint8_t>& payload);
+
+    // Wait up to timeout_ms (-1 = forever) for the next packet from the client
+    ReceiveStatus receivePacket(SendablePacket_t& header, std::vector<uint8_t>& payload, int timeout_ms = -1);
+
+    // Reply to a lockstep request (step, save or restore), echoing its sequence number so the client can match the round trip
+    bool sendStepResponse(int unit_id, uint32_t seq, uint64_t step, double time,
+                          const chrono::ChVector3<double>& position,
+                          const chrono::ChQuaternion<double>& rotation, double speed,
+                          TerrainSystemCoordinates &terrain_system);
 };
 
 #endif  // TCP_POSITION_SERVER_HPP
\ No newline at end of file
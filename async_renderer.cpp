@@ -0,0 +1,193 @@
+#include "async_renderer.hpp"
+#include "thread_budget.hpp"
+#include "chrono_irrlicht/ChVisualSystemIrrlicht.h"
+#include <cmath>
+#include <iostream>
+
+using namespace chrono;
+using namespace chrono::vehicle;
+
+AsyncRenderer::Settings::Settings()
+    : windowTitle("Generic Vehicle on SCM Terrain")
+    , terrainDelta(0.1)
+    , wireframe(false)
+    , chasePoint(0.0, 0.0, 1.75)
+    , chaseDistance(6.0)
+    , chaseHeight(0.5) {}
+
+AsyncRenderer::AsyncRenderer(ChSystem* system,
+                             std::shared_ptr<SCMTerrain> terrain,
+                             std::shared_ptr<ChBody> chase_body,
+                             const Settings& settings)
+    : settings_(settings)
+    , chase_body_(chase_body)
+    , terrain_(terrain)
+    , front_fresh_(false)
+    , running_(false)
+    , stop_(false) {
+    // Mirror every visible body; visual shapes are immutable after setup, so they are shared
+    for (auto& body : system->GetBodies()) {
+        auto model = body->GetVisualModel();
+        if (!model) continue;
+
+        auto mirror = chrono_types::make_shared<ChBody>();
+        mirror->SetFixed(true);
+        mirror->EnableCollision(false);
+        for (auto& instance : model->GetShapeInstances()) {
+            mirror->AddVisualShape(instance.first, instance.second);
+        }
+        mirror->SetPos(body->GetPos());
+        mirror->SetRot(body->GetRot());
+        mirror_.AddBody(mirror);
+
+        sources_.push_back(body);
+        mirrors_.push_back(mirror);
+    }
+
+    // The SCM mesh is rewritten by physics every step, so the render side gets its own copy
+    mesh_ = chrono_types::make_shared<ChTriangleMeshConnected>(*terrain->GetMesh()->GetMesh());
+    const auto& vertices = mesh_->GetCoordsVertices();
+    node_to_vertex_.reserve(vertices.size());
+    for (unsigned int i = 0; i < vertices.size(); i++) {
+        int ix = (int)std::lround(vertices[i].x() / settings_.terrainDelta);
+        int iy = (int)std::lround(vertices[i].y() / settings_.terrainDelta);
+        node_to_vertex_[NodeKey(ix, iy)] = i;
+    }
+
+    auto terrain_shape = chrono_types::make_shared<ChVisualShapeTriangleMesh>();
+    terrain_shape->SetMesh(mesh_);
+    terrain_shape->SetMutable(true);
+    terrain_shape->SetWireframe(settings_.wireframe);
+    if (!settings_.terrainTexture.empty()) {
+        terrain_shape->SetTexture(settings_.terrainTexture, 1, -1);
+    }
+    auto terrain_body = chrono_types::make_shared<ChBody>();
+    terrain_body->SetFixed(true);
+    terrain_body->EnableCollision(false);
+    terrain_body->AddVisualShape(terrain_shape);
+    mirror_.AddBody(terrain_body);
+
+    back_.bodies.resize(sources_.size());
+    front_.bodies.resize(sources_.size());
+    render_.bodies.resize(sources_.size());
+    render_.chase = ChFrame<>(chase_body->GetPos(), chase_body->GetRot());
+}
+
+AsyncRenderer::~AsyncRenderer() {
+    Stop();
+}
+
+void AsyncRenderer::Start() {
+    stop_ = false;
+    running_ = true;
+    thread_ = std::thread(&AsyncRenderer::RenderLoop, this);
+}
+
+void AsyncRenderer::Stop() {
+    stop_ = true;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void AsyncRenderer::CollectTerrainChanges() {
+    CollectTerrainChanges(terrain_->GetModifiedNodes(false));
+}
+
+void AsyncRenderer::CollectTerrainChanges(const std::vector<SCMTerrain::NodeLevel>& nodes) {
+    for (const auto& node : nodes) {
+        auto it = node_to_vertex_.find(NodeKey(node.first.x(), node.first.y()));
+        if (it != node_to_vertex_.end()) {
+            pending_vertices_[it->second] = node.second;
+        }
+    }
+}
+
+void AsyncRenderer::Submit(double time) {
+    back_.time = time;
+    for (size_t i = 0; i < sources_.size(); i++) {
+        back_.bodies[i] = ChFrame<>(sources_[i]->GetPos(), sources_[i]->GetRot());
+    }
+    back_.chase = ChFrame<>(chase_body_->GetPos(), chase_body_->GetRot());
+    for (const auto& vertex : pending_vertices_) {
+        back_.vertices.push_back(vertex);
+    }
+    pending_vertices_.clear();
+
+    {
+        std::lock_guard<std::mutex> lock(swap_mutex_);
+        if (front_fresh_) {
+            // The previous frame was never drawn: take its place but keep its terrain edits
+            front_.vertices.insert(front_.vertices.end(), back_.vertices.begin(), back_.vertices.end());
+            std::swap(front_.bodies, back_.bodies);
+            front_.chase = back_.chase;
+            front_.time = back_.time;
+        } else {
+            std::swap(front_, back_);
+        }
+        front_fresh_ = true;
+    }
+    back_.vertices.clear();
+}
+
+void AsyncRenderer::Apply(const Frame& frame) {
+    for (size_t i = 0; i < mirrors_.size(); i++) {
+        mirrors_[i]->SetPos(frame.bodies[i].GetPos());
+        mirrors_[i]->SetRot(frame.bodies[i].GetRot());
+    }
+
+    auto& vertices = mesh_->GetCoordsVertices();
+    for (const auto& vertex : frame.vertices) {
+        vertices[vertex.first].z() = vertex.second;
+    }
+}
+
+void AsyncRenderer::RenderLoop() {
+    ThreadBudget::PinCurrentThread(ThreadBudget::Role::RENDER);
+
+    // The Irrlicht device and its GL context live on this thread only
+    auto vis = chrono_types::make_shared<irrlicht::ChVisualSystemIrrlicht>();
+    vis->AttachSystem(&mirror_);
+    vis->SetWindowTitle(settings_.windowTitle);
+    vis->Initialize();
+    vis->AddSkyBox();
+    vis->AddLogo();
+    ChVector3d start = render_.chase.GetPos();
+    vis->AddCamera(start + ChVector3d(-settings_.chaseDistance, 0, settings_.chaseHeight), start);
+    vis->AddLightDirectional(60, 60.0, ChColor(0.8f, 0.8f, 0.8f));
+
+    while (!stop_ && vis->Run()) {
+        bool fresh = false;
+        {
+            std::lock_guard<std::mutex> lock(swap_mutex_);
+            if (front_fresh_) {
+                std::swap(front_, render_);
+                front_fresh_ = false;
+                fresh = true;
+            }
+        }
+        if (!fresh) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+
+        Apply(render_);
+        render_.vertices.clear();
+
+        // Chase camera behind the chassis, looking at a point above it
+        ChVector3d target = render_.chase.TransformPointLocalToParent(settings_.chasePoint);
+        ChVector3d heading = render_.chase.GetRot().GetAxisX();
+        heading.z() = 0;
+        if (heading.Length() > 1e-6) {
+            heading = heading.GetNormalized();
+        }
+        vis->SetCameraTarget(target);
+        vis->SetCameraPosition(target - heading * settings_.chaseDistance + ChVector3d(0, 0, settings_.chaseHeight));
+
+        vis->BeginScene();
+        vis->Render();
+        vis->EndScene();
+    }
+
+    running_ = false;
+}
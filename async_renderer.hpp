@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "chrono/physics/ChSystemNSC.h"
+#include "chrono/physics/ChBody.h"
+#include "chrono/assets/ChVisualShapeTriangleMesh.h"
+#include "chrono_vehicle/terrain/SCMTerrain.h"
+
+// Renders the simulation with Irrlicht on its own thread. The render thread never touches
+// the physics system: it draws a private mirror system whose fixed bodies share the visual
+// shapes of the real bodies and whose terrain is a copy of the SCM mesh. The physics thread
+// hands over body transforms and changed terrain vertices through a double buffer.
+class AsyncRenderer {
+public:
+    struct Settings {
+        std::string windowTitle;
+        double terrainDelta;        // SCM grid spacing, used to map grid nodes to mesh vertices
+        bool wireframe;
+        std::string terrainTexture;
+        chrono::ChVector3d chasePoint;  // Camera target in chassis frame
+        double chaseDistance;
+        double chaseHeight;
+
+        Settings();
+    };
+
+    // Build the mirror scene; call on the physics thread once the system is fully set up
+    AsyncRenderer(chrono::ChSystem* system,
+                  std::shared_ptr<chrono::vehicle::SCMTerrain> terrain,
+                  std::shared_ptr<chrono::ChBody> chase_body,
+                  const Settings& settings = Settings());
+    ~AsyncRenderer();
+
+    void Start();
+    void Stop();
+
+    // Physics thread, every step: remember terrain nodes deformed by this step
+    void CollectTerrainChanges();
+
+    // Physics thread: remember terrain nodes changed outside a step (e.g. by a snapshot restore)
+    void CollectTerrainChanges(const std::vector<chrono::vehicle::SCMTerrain::NodeLevel>& nodes);
+
+    // Physics thread, at render rate: publish the current transforms and pending terrain edits
+    void Submit(double time);
+
+    // False once the window has been closed
+    bool IsRunning() const { return running_; }
+
+private:
+    struct Frame {
+        double time = 0;
+        std::vector<chrono::ChFrame<>> bodies;
+        std::vector<std::pair<unsigned int, double>> vertices;  // (vertex index, new height)
+        chrono::ChFrame<> chase;
+    };
+
+    static int64_t NodeKey(int i, int j) { return ((int64_t)i << 32) ^ (uint32_t)j; }
+
+    void RenderLoop();
+    void Apply(const Frame& frame);
+
+    Settings settings_;
+
+    // Physics-side sources
+    std::vector<std::shared_ptr<chrono::ChBody>> sources_;
+    std::shared_ptr<chrono::ChBody> chase_body_;
+    std::shared_ptr<chrono::vehicle::SCMTerrain> terrain_;
+    std::unordered_map<int64_t, unsigned int> node_to_vertex_;
+    std::unordered_map<unsigned int, double> pending_vertices_;
+
+    // Render-side mirror scene
+    chrono::ChSystemNSC mirror_;
+    std::vector<std::shared_ptr<chrono::ChBody>> mirrors_;
+    std::shared_ptr<chrono::ChTriangleMeshConnected> mesh_;
+
+    // Double buffer between the threads; render_ is owned by the render thread
+    Frame back_;
+    Frame front_;
+    Frame render_;
+    bool front_fresh_;
+    std::mutex swap_mutex_;
+
+    std::thread thread_;
+    std::atomic<bool> running_;
+    std::atomic<bool> stop_;
+};
@@ -0,0 +1,99 @@
+#include "backend_benchmark.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+
+#include "trajectory_log.hpp"
+
+using namespace chrono;
+
+BackendBenchmark::BackendBenchmark(const ChronoSimulation::Config& config) : config_(config) {
+    // Same headless, unpaced setup as a sweep case, so only the backend differs between runs
+    config_.useTcpServer = false;
+    config_.lockstep = false;
+    config_.useRos = false;
+    config_.useVisualization = false;
+    config_.realtimeMode = false;
+    config_.adaptiveStep = false;
+    config_.qosGovernor = false;
+    config_.externalInputs = false;
+    config_.scriptedDriver = true;
+    config_.watchdog = false;  // Not available on Multicore; a rollback would also skew the timing
+    config_.regionSettings.regions = 1;
+    config_.terrainNode.clear();
+    config_.recordInputsFile.clear();
+    config_.trajectoryFile.clear();
+    if (config_.duration <= 0) {
+        config_.duration = 10.0;
+    }
+}
+
+bool BackendBenchmark::Run(std::ostream& os) {
+    std::vector<Result> results;
+    for (auto backend : {ChronoSimulation::SystemBackend::NSC, ChronoSimulation::SystemBackend::MULTICORE}) {
+        if (!ChronoSimulation::IsBackendAvailable(backend)) {
+            os << "Backend " << ChronoSimulation::GetBackendName(backend) << ": not in this build" << std::endl;
+            continue;
+        }
+        results.push_back(RunBackend(backend));
+    }
+
+    os << std::fixed << std::setprecision(3);
+    os << "backend     init(s)  wall(s)  steps/s    RTF  max_sinkage(m)  final position" << std::endl;
+    for (const auto& result : results) {
+        double rtf = result.simTime > 0 ? result.wallTime / result.simTime : 0;
+        os << std::left << std::setw(10) << ChronoSimulation::GetBackendName(result.backend) << std::right
+           << std::setw(9) << result.initTime << std::setw(9) << result.wallTime << std::setw(9)
+           << (result.wallTime > 0 ? result.steps / result.wallTime : 0) << std::setw(7) << rtf << std::setw(16)
+           << result.maxSinkage << "  " << result.finalPos << std::endl;
+    }
+
+    // Behaviour: every other backend against the NSC reference
+    bool ok = true;
+    for (size_t i = 1; i < results.size(); i++) {
+        os << "Deviation of " << ChronoSimulation::GetBackendName(results[i].backend) << " from "
+           << ChronoSimulation::GetBackendName(results[0].backend) << ":" << std::endl;
+        ok = TrajectoryLog::Compare(results[0].trajectoryFile, results[i].trajectoryFile, os) && ok;
+    }
+    return ok;
+}
+
+BackendBenchmark::Result BackendBenchmark::RunBackend(ChronoSimulation::SystemBackend backend) const {
+    Result result;
+    result.backend = backend;
+    result.trajectoryFile = std::string("backend_") + ChronoSimulation::GetBackendName(backend) + ".csv";
+
+    ChronoSimulation::Config config = config_;
+    config.systemBackend = backend;
+
+    auto init_start = std::chrono::steady_clock::now();
+    ChronoSimulation sim(config);
+    sim.Initialize();
+    result.initTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - init_start).count();
+
+    TrajectoryLog trajectory;
+    bool logging = trajectory.Open(result.trajectoryFile);
+    double sample_period = config.trajectoryRate > 0 ? 1.0 / config.trajectoryRate : 0.1;
+    double next_sample = 0;
+
+    double step = sim.GetStepSize();
+    int steps = (int)std::lround(config.duration / step);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < steps; i++) {
+        double time = sim.GetSystem()->GetChTime();
+        if (logging && time + 0.5 * step >= next_sample) {
+            // Sampled with the trajectory rather than every step, to keep it out of the throughput
+            trajectory.Write(time, sim.GetVehicleState(0));
+            result.maxSinkage = std::max(result.maxSinkage, sim.GetMaxSinkage());
+            next_sample += sample_period;
+        }
+        sim.Advance(1);
+    }
+    result.wallTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.simTime = sim.GetSystem()->GetChTime();
+    result.steps = steps;
+    result.finalPos = sim.GetVehicleState(0).pos;
+    return result;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "main.h"
+
+// Runs the same headless scenario (scripted maneuver, fixed step) on every system backend
+// compiled in and compares them: initialization time and stepping throughput, plus the
+// trajectory of vehicle 0, logged per backend to backend_<name>.csv and compared against the
+// NSC run with TrajectoryLog::Compare().
+class BackendBenchmark {
+public:
+    explicit BackendBenchmark(const ChronoSimulation::Config& config);
+
+    // False if a backend could not be run or its trajectory not compared
+    bool Run(std::ostream& os);
+
+private:
+    struct Result {
+        ChronoSimulation::SystemBackend backend;
+        std::string trajectoryFile;
+        double initTime = 0;  // Wall time of Initialize() (s)
+        double wallTime = 0;  // Wall time of the stepping loop (s)
+        double simTime = 0;
+        int steps = 0;
+        double maxSinkage = 0;
+        chrono::ChVector3d finalPos;
+    };
+
+    Result RunBackend(ChronoSimulation::SystemBackend backend) const;
+
+    ChronoSimulation::Config config_;
+};
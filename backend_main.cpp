@@ -0,0 +1,120 @@
+#include "command_line.hpp"
+#include "simulation_launcher.h"
+#include "terrain_node.hpp"
+#include "backend_benchmark.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+using namespace chrono;
+
+static int RunMain(int argc, char* argv[]) {
+    ChronoSimulation::Config config;
+    ThreadBudget::Settings thread_budget;
+    SimulationServer::Settings server;
+    BatchEnvironment::Settings batch;
+    batch.numEnvs = 0;
+    SweepRunner::Settings sweep;
+
+    int code = ParseArguments(argc, argv, config, thread_budget, server, batch, sweep);
+    if (code >= 0) {
+        return code;
+    }
+
+    // Thread budget must be in place before any simulation or I/O thread starts
+    ThreadBudget::Configure(thread_budget);
+
+    // Server mode: the arguments become defaults for sessions created over the control socket
+    if (server.port > 0) {
+        auto parser = [](const std::vector<std::string>& args, ChronoSimulation::Config& session_config,
+                         std::string& error) {
+            std::vector<char*> session_argv{const_cast<char*>("session")};
+            for (const auto& arg : args) {
+                session_argv.push_back(const_cast<char*>(arg.c_str()));
+            }
+            // Thread budget and server options are process-wide and ignored per session
+            ThreadBudget::Settings unused_budget;
+            SimulationServer::Settings unused_server;
+            BatchEnvironment::Settings unused_batch;
+            SweepRunner::Settings unused_sweep;
+            if (ParseArguments((int)session_argv.size(), session_argv.data(), session_config, unused_budget,
+                               unused_server, unused_batch, unused_sweep) >= 0) {
+                error = "invalid session arguments";
+                return false;
+            }
+            if (session_config.serveTerrain || session_config.compareBackends) {
+                error = "--serve-terrain and --compare-backends are not session options";
+                return false;
+            }
+            return true;
+        };
+        SimulationServer simulation_server(config, parser, server);
+        simulation_server.Run();
+        return 0;
+    }
+
+    // Terrain node: SCM only, for a vehicle process started with --terrain-node
+    if (config.serveTerrain) {
+        TerrainNode node(config, config.terrainNode);
+        return node.Run() ? 0 : 1;
+    }
+
+    // Backend comparison: same scenario on NSC and (if built in) Multicore
+    if (config.compareBackends) {
+        BackendBenchmark benchmark(config);
+        return benchmark.Run(std::cout) ? 0 : 1;
+    }
+
+    // Sweep mode: every case of the parameter grid headless, summary rows to a CSV
+    if (!sweep.gridFile.empty()) {
+        SweepRunner runner(config, sweep);
+        if (!runner.LoadGrid() || !runner.Run()) {
+            return 1;
+        }
+        return 0;
+    }
+
+    // Batch mode: step B headless copies in-process with constant inputs and report throughput
+    if (batch.numEnvs > 0) {
+        BatchEnvironment env(config, batch);
+        BatchEnvironment::Actions actions;
+        actions.Resize(env.GetNumSlots());
+        std::fill(actions.throttle.begin(), actions.throttle.end(), 0.5f);
+
+        double duration = config.duration > 0 ? config.duration : 10.0;
+        int calls = std::max(1, (int)(duration / (config.stepSize * batch.stepsPerAction)));
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < calls; i++) {
+            env.Step(actions);
+        }
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "Batch: " << calls << " steps of " << env.GetNumSlots() << " vehicles in " << elapsed
+                  << " s, " << calls * env.GetNumSlots() / elapsed << " samples/s, sim time "
+                  << env.GetObservations().time[0] << " s" << std::endl;
+        return 0;
+    }
+    
+    // Print initial configuration
+    std::cout << "Starting simulation with:\n"
+              << "Position: " << config.initLoc.x() << " " 
+              << config.initLoc.y() << " " 
+              << config.initLoc.z() << "\n"
+              << "Rotation (quaternion): " << config.initRot << "\n"
+              << "Unreal Z offset: " << config.unrealZOfsset << std::endl;
+
+    // Launch simulation
+    SimulationLauncher launcher(config);
+    launcher.Launch();
+    return launcher.Join() ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+    // Batch, sweep and benchmark runs report a failed simulation the same way as a single run
+    try {
+        return RunMain(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,151 @@
+#include "batch_environment.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace chrono;
+using namespace chrono::vehicle;
+
+BatchEnvironment::Settings::Settings() : numEnvs(8), stepsPerAction(10), threads(0), threadsPerEnv(1) {}
+
+void BatchEnvironment::Actions::Resize(size_t slots) {
+    throttle.assign(slots, 0.0f);
+    steering.assign(slots, 0.0f);
+    braking.assign(slots, 0.0f);
+}
+
+void BatchEnvironment::Observations::Resize(size_t envs, size_t slots) {
+    time.assign(envs, 0.0);
+    for (auto* field : {&posX, &posY, &posZ, &rotW, &rotX, &rotY, &rotZ, &velX, &velY, &velZ, &speed, &imuAccX,
+                        &imuAccY, &imuAccZ, &imuGyroX, &imuGyroY, &imuGyroZ}) {
+        field->assign(slots, 0.0f);
+    }
+    wheelOmega.assign(slots * kWheels, 0.0f);
+    wheelSinkage.assign(slots * kWheels, 0.0f);
+}
+
+BatchEnvironment::BatchEnvironment(const ChronoSimulation::Config& config, const Settings& settings)
+    : settings_(settings), vehicles_(0) {
+    // Everything that would leave the process or pace to wall clock is off
+    ChronoSimulation::Config env_config = config;
+    env_config.externalInputs = true;
+    env_config.useTcpServer = false;
+    env_config.lockstep = false;
+    env_config.useRos = false;
+    env_config.useVisualization = false;
+    env_config.realtimeMode = false;
+    env_config.adaptiveStep = false;
+    env_config.qosGovernor = false;
+    env_config.spawnPoolSize = 0;
+    env_config.regionSettings.regions = 1;
+    env_config.terrainNode.clear();
+    env_config.recordInputsFile.clear();
+    env_config.replayInputsFile.clear();
+    env_config.trajectoryFile.clear();
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < settings_.numEnvs; i++) {
+        auto env = std::make_unique<ChronoSimulation>(env_config);
+        env->Initialize();
+        // Parallelism comes from running environments side by side
+        env->GetSystem()->SetNumThreads(settings_.threadsPerEnv, settings_.threadsPerEnv, 1);
+        initial_.push_back(env->SaveSnapshot());
+        envs_.push_back(std::move(env));
+    }
+    vehicles_ = envs_.empty() ? 0 : envs_[0]->GetNumVehicles();
+
+    int threads = settings_.threads > 0 ? settings_.threads : settings_.numEnvs;
+    pool_ = std::make_unique<WorkerPool>(threads);
+    observations_.Resize(envs_.size(), GetNumSlots());
+    for (int i = 0; i < GetNumEnvs(); i++) {
+        Observe(i);
+    }
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Batch environment: " << GetNumEnvs() << " environments x " << vehicles_ << " vehicles on "
+              << pool_->GetNumThreads() << " threads, built in " << elapsed << " s" << std::endl;
+}
+
+BatchEnvironment::~BatchEnvironment() {}
+
+void BatchEnvironment::Step(const Actions& actions) {
+    size_t slots = GetNumSlots();
+    if (actions.throttle.size() != slots || actions.steering.size() != slots || actions.braking.size() != slots) {
+        throw std::invalid_argument("BatchEnvironment::Step: expected " + std::to_string(slots) +
+                                    " actions per input, got throttle " + std::to_string(actions.throttle.size()) +
+                                    ", steering " + std::to_string(actions.steering.size()) + ", braking " +
+                                    std::to_string(actions.braking.size()));
+    }
+    pool_->ParallelFor(0, GetNumEnvs(), [&](int env) {
+        ChronoSimulation& sim = *envs_[env];
+        for (int v = 0; v < vehicles_; v++) {
+            int slot = env * vehicles_ + v;
+            sim.SetInputs(v, actions.throttle[slot], actions.steering[slot], actions.braking[slot]);
+        }
+        sim.Advance(settings_.stepsPerAction);
+        Observe(env);
+    });
+}
+
+void BatchEnvironment::Reset(const std::vector<int>& envs) {
+    auto reset = [&](int env) {
+        envs_[env]->RestoreSnapshot(*initial_[env]);
+        Observe(env);
+    };
+    if (envs.empty()) {
+        pool_->ParallelFor(0, GetNumEnvs(), reset);
+    } else {
+        pool_->ParallelFor(0, (int)envs.size(), [&](int i) { reset(envs[i]); });
+    }
+}
+
+void BatchEnvironment::Observe(int env) {
+    // Each environment writes only its own slots, so environments can observe concurrently
+    const ChronoSimulation& sim = *envs_[env];
+    Observations& obs = observations_;
+    obs.time[env] = sim.GetSystem()->GetChTime();
+
+    for (int v = 0; v < vehicles_; v++) {
+        int slot = env * vehicles_ + v;
+        VehicleState state = sim.GetVehicleState(v);
+        const ChWheeledVehicle& vehicle = sim.GetVehicle(v);
+
+        obs.posX[slot] = (float)state.pos.x();
+        obs.posY[slot] = (float)state.pos.y();
+        obs.posZ[slot] = (float)state.pos.z();
+        obs.rotW[slot] = (float)state.rot.e0();
+        obs.rotX[slot] = (float)state.rot.e1();
+        obs.rotY[slot] = (float)state.rot.e2();
+        obs.rotZ[slot] = (float)state.rot.e3();
+        obs.velX[slot] = (float)state.vel.x();
+        obs.velY[slot] = (float)state.vel.y();
+        obs.velZ[slot] = (float)state.vel.z();
+        obs.speed[slot] = (float)vehicle.GetSpeed();
+
+        // IMU: specific force and angular rate in the chassis frame
+        ChVector3d acc = state.rot.RotateBack(state.acc) + state.rot.RotateBack(ChVector3d(0, 0, 9.81));
+        ChVector3d gyro = state.rot.RotateBack(2.0 * (state.rotDt * state.rot.GetConjugate()).GetVector());
+        obs.imuAccX[slot] = (float)acc.x();
+        obs.imuAccY[slot] = (float)acc.y();
+        obs.imuAccZ[slot] = (float)acc.z();
+        obs.imuGyroX[slot] = (float)gyro.x();
+        obs.imuGyroY[slot] = (float)gyro.y();
+        obs.imuGyroZ[slot] = (float)gyro.z();
+
+        int wheel = 0;
+        for (auto& axle : vehicle.GetAxles()) {
+            for (auto& w : axle->GetWheels()) {
+                if (wheel >= kWheels) break;
+                ChVector3d pos = w->GetSpindle()->GetPos();
+                double bottom = pos.z() - w->GetTire()->GetRadius();
+                obs.wheelOmega[slot * kWheels + wheel] = (float)w->GetSpindle()->GetAngVelLocal().y();
+                obs.wheelSinkage[slot * kWheels + wheel] =
+                    (float)std::max(0.0, sim.GetTerrain()->GetInitHeight(pos) - bottom);
+                wheel++;
+            }
+        }
+    }
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "main.h"
+#include "worker_pool.hpp"
+
+// B independent copies of the vehicle-on-SCM scenario stepped together in-process. Each copy
+// is a ChronoSimulation with its own system and terrain, built headless and without TCP or
+// ROS. Actions and observations are structure-of-arrays buffers indexed by
+// slot = env * vehicles + vehicle, so a learner can hand them over without repacking.
+// Copies are stepped in parallel on a worker pool.
+//
+// All observations are in the Chrono world frame (Z up), the IMU quantities in the chassis frame.
+class BatchEnvironment {
+public:
+    struct Settings {
+        int numEnvs;          // B
+        int stepsPerAction;   // Physics steps per Step() call
+        int threads;          // Worker threads across environments, 0 = one per environment
+        int threadsPerEnv;    // Chrono threads inside each environment
+
+        Settings();
+    };
+
+    // Inputs per slot, clamped like ExternalDriver inputs
+    struct Actions {
+        std::vector<float> throttle;
+        std::vector<float> steering;
+        std::vector<float> braking;
+
+        void Resize(size_t slots);
+    };
+
+    static const int kWheels = 4;
+
+    struct Observations {
+        std::vector<double> time;  // Per environment
+
+        // Per slot
+        std::vector<float> posX, posY, posZ;
+        std::vector<float> rotW, rotX, rotY, rotZ;
+        std::vector<float> velX, velY, velZ;
+        std::vector<float> speed;         // Forward speed (m/s)
+        std::vector<float> imuAccX, imuAccY, imuAccZ;  // Specific force, gravity included
+        std::vector<float> imuGyroX, imuGyroY, imuGyroZ;
+
+        // Per slot and wheel, index slot * kWheels + wheel (front left, front right, rear left, rear right)
+        std::vector<float> wheelOmega;    // Spin rate (rad/s)
+        std::vector<float> wheelSinkage;  // Depth below the undeformed surface (m)
+
+        void Resize(size_t envs, size_t slots);
+    };
+
+    BatchEnvironment(const ChronoSimulation::Config& config, const Settings& settings = Settings());
+    ~BatchEnvironment();
+
+    int GetNumEnvs() const { return (int)envs_.size(); }
+    int GetNumVehicles() const { return vehicles_; }
+    int GetNumSlots() const { return GetNumEnvs() * vehicles_; }
+    const Observations& GetObservations() const { return observations_; }
+
+    // Apply actions, advance every environment by stepsPerAction steps and refresh the observations.
+    // Throws std::invalid_argument unless throttle, steering and braking each hold GetNumSlots() values.
+    void Step(const Actions& actions);
+
+    // Return environments to their initial state; envs lists the indices, empty = all
+    void Reset(const std::vector<int>& envs = std::vector<int>());
+
+private:
+    void Observe(int env);
+
+    Settings settings_;
+    std::vector<std::unique_ptr<ChronoSimulation>> envs_;
+    std::vector<std::shared_ptr<SimulationSnapshot>> initial_;
+    std::unique_ptr<WorkerPool> pool_;
+    int vehicles_;
+    Observations observations_;
+};
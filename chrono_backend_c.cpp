@@ -0,0 +1,283 @@
+#include "chrono_backend_c.h"
+
+#include <algorithm>
+#include <exception>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "command_line.hpp"
+#include "rollout_service.hpp"
+
+using namespace chrono;
+
+struct cb_config {
+    ChronoSimulation::Config config;
+};
+
+struct cb_simulation {
+    std::unique_ptr<ChronoSimulation> simulation;
+    std::unique_ptr<RolloutService> rollouts;  // Built on the first cb_rollout call
+    int rolloutWorkers = 0;
+};
+
+struct cb_snapshot {
+    std::shared_ptr<SimulationSnapshot> snapshot;
+};
+
+static thread_local std::string last_error;
+
+static int Fail(const std::string& message) {
+    last_error = message;
+    return -1;
+}
+
+static bool ValidVehicle(const cb_simulation* sim, int vehicle) {
+    if (!sim) {
+        last_error = "null simulation";
+        return false;
+    }
+    if (vehicle < 0 || vehicle >= sim->simulation->GetNumVehicles()) {
+        last_error = "no vehicle " + std::to_string(vehicle);
+        return false;
+    }
+    return true;
+}
+
+int cb_api_version(void) {
+    return CB_API_VERSION;
+}
+
+const char* cb_last_error(void) {
+    return last_error.c_str();
+}
+
+cb_config* cb_config_create(void) {
+    try {
+        auto* config = new cb_config();
+        config->config.externalInputs = true;
+        config->config.useTcpServer = false;
+        config->config.useRos = false;
+        config->config.useVisualization = false;
+        config->config.adaptiveStep = false;
+        return config;
+    } catch (const std::exception& e) {
+        Fail(e.what());
+        return nullptr;
+    }
+}
+
+void cb_config_destroy(cb_config* config) {
+    delete config;
+}
+
+int cb_config_parse_args(cb_config* config, int argc, const char* const* argv) {
+    if (!config) return Fail("null config");
+
+    try {
+        std::vector<std::string> args{"chrono_backend"};
+        for (int i = 0; i < argc; i++) {
+            args.push_back(argv[i]);
+        }
+        std::vector<char*> arg_ptrs;
+        for (auto& arg : args) {
+            arg_ptrs.push_back(&arg[0]);
+        }
+
+        // Thread budget, server, batch and sweep options belong to the executable and are ignored
+        ThreadBudget::Settings thread_budget;
+        SimulationServer::Settings server;
+        BatchEnvironment::Settings batch;
+        SweepRunner::Settings sweep;
+        if (ParseArguments((int)arg_ptrs.size(), arg_ptrs.data(), config->config, thread_budget, server, batch,
+                           sweep) >= 0) {
+            return Fail("invalid options");
+        }
+    } catch (const std::exception& e) {
+        return Fail(e.what());
+    }
+    return 0;
+}
+
+cb_simulation* cb_create(const cb_config* config) {
+    if (!config) {
+        Fail("null config");
+        return nullptr;
+    }
+    try {
+        auto sim = std::make_unique<cb_simulation>();
+        sim->simulation = std::make_unique<ChronoSimulation>(config->config);
+        sim->simulation->Initialize();
+        return sim.release();
+    } catch (const std::exception& e) {
+        Fail(e.what());
+        return nullptr;
+    }
+}
+
+void cb_destroy(cb_simulation* sim) {
+    delete sim;
+}
+
+int cb_num_vehicles(const cb_simulation* sim) {
+    return sim ? sim->simulation->GetNumVehicles() : Fail("null simulation");
+}
+
+double cb_time(const cb_simulation* sim) {
+    return sim ? sim->simulation->GetSystem()->GetChTime() : 0.0;
+}
+
+double cb_step_size(const cb_simulation* sim) {
+    return sim ? sim->simulation->GetStepSize() : 0.0;
+}
+
+int cb_set_inputs(cb_simulation* sim, int vehicle, double throttle, double steering, double braking) {
+    if (!ValidVehicle(sim, vehicle)) return -1;
+    if (!sim->simulation->GetConfig().externalInputs) return Fail("inputs are not external in this config");
+    try {
+        sim->simulation->SetInputs(vehicle, throttle, steering, braking);
+    } catch (const std::exception& e) {
+        return Fail(e.what());
+    }
+    return 0;
+}
+
+int cb_step(cb_simulation* sim, int steps) {
+    if (!sim) return Fail("null simulation");
+    try {
+        sim->simulation->Advance(steps);
+    } catch (const std::exception& e) {
+        return Fail(e.what());
+    }
+    return 0;
+}
+
+static void CopyState(const VehicleState& state, double time, double speed, cb_vehicle_state* out) {
+    ChVector3d ang_vel = 2.0 * (state.rotDt * state.rot.GetConjugate()).GetVector();
+    out->time = time;
+    auto copy = [](const ChVector3d& v, double* dst) {
+        dst[0] = v.x();
+        dst[1] = v.y();
+        dst[2] = v.z();
+    };
+    copy(state.pos, out->pos);
+    copy(state.vel, out->vel);
+    copy(state.acc, out->acc);
+    copy(ang_vel, out->ang_vel);
+    out->rot[0] = state.rot.e0();
+    out->rot[1] = state.rot.e1();
+    out->rot[2] = state.rot.e2();
+    out->rot[3] = state.rot.e3();
+    out->speed = speed;
+}
+
+int cb_get_state(const cb_simulation* sim, int vehicle, cb_vehicle_state* out) {
+    if (!ValidVehicle(sim, vehicle)) return -1;
+    if (!out) return Fail("null output");
+    CopyState(sim->simulation->GetVehicleState(vehicle), sim->simulation->GetSystem()->GetChTime(),
+              sim->simulation->GetVehicle(vehicle).GetSpeed(), out);
+    return 0;
+}
+
+int cb_get_states(const cb_simulation* sim, cb_vehicle_state* out, size_t capacity) {
+    if (!sim) return Fail("null simulation");
+    if (!out && capacity > 0) return Fail("null output");
+    size_t count = std::min(capacity, (size_t)sim->simulation->GetNumVehicles());
+    for (size_t i = 0; i < count; i++) {
+        if (cb_get_state(sim, (int)i, &out[i]) < 0) return -1;
+    }
+    return (int)count;
+}
+
+cb_snapshot* cb_snapshot_save(cb_simulation* sim) {
+    if (!sim) {
+        Fail("null simulation");
+        return nullptr;
+    }
+    try {
+        auto snapshot = std::make_unique<cb_snapshot>();
+        snapshot->snapshot = sim->simulation->SaveSnapshot();
+        return snapshot.release();
+    } catch (const std::exception& e) {
+        Fail(e.what());
+        return nullptr;
+    }
+}
+
+int cb_snapshot_restore(cb_simulation* sim, const cb_snapshot* snapshot) {
+    if (!sim || !snapshot) return Fail("null simulation or snapshot");
+    try {
+        sim->simulation->RestoreSnapshot(*snapshot->snapshot);
+    } catch (const std::exception& e) {
+        return Fail(e.what());
+    }
+    return 0;
+}
+
+void cb_snapshot_destroy(cb_snapshot* snapshot) {
+    delete snapshot;
+}
+
+int cb_rollout(cb_simulation* sim, int workers, int vehicle, int num_candidates, const int* segment_counts,
+               const cb_rollout_segment* segments, double sample_interval, cb_rollout_result* results,
+               cb_vehicle_state* trajectories, size_t max_samples) {
+    if (!ValidVehicle(sim, vehicle)) return -1;
+    if (num_candidates < 0 || (num_candidates > 0 && (!segment_counts || !segments || !results))) {
+        return Fail("invalid candidates");
+    }
+
+    for (int c = 0; c < num_candidates; c++) {
+        if (segment_counts[c] < 0) return Fail("negative segment count for candidate " + std::to_string(c));
+    }
+
+    std::vector<RolloutService::Result> rollouts;
+    try {
+        // Workers are rebuilt only when their number changes; the sample interval is per candidate
+        workers = std::max(workers, 1);
+        if (!sim->rollouts || sim->rolloutWorkers != workers) {
+            RolloutService::Settings settings;
+            settings.workers = workers;
+            sim->rollouts.reset();
+            sim->rollouts = std::make_unique<RolloutService>(sim->simulation->GetConfig(), settings);
+            sim->rolloutWorkers = workers;
+        }
+
+        std::vector<RolloutService::Candidate> candidates(num_candidates);
+        int offset = 0;
+        for (int c = 0; c < num_candidates; c++) {
+            candidates[c].vehicle = vehicle;
+            if (sample_interval > 0) {
+                candidates[c].sampleInterval = sample_interval;
+            }
+            for (int s = 0; s < segment_counts[c]; s++) {
+                const cb_rollout_segment& segment = segments[offset + s];
+                candidates[c].segments.push_back(
+                    {segment.duration, segment.throttle, segment.steering, segment.braking});
+            }
+            offset += segment_counts[c];
+        }
+
+        rollouts = sim->rollouts->Evaluate(sim->simulation->SaveSnapshot(), candidates);
+    } catch (const std::exception& e) {
+        return Fail(e.what());
+    }
+
+    // Rollout states carry no vehicle object, so the forward speed comes from the chassis velocity
+    auto forward_speed = [](const VehicleState& state) { return state.rot.RotateBack(state.vel).x(); };
+    for (int c = 0; c < num_candidates; c++) {
+        const RolloutService::Result& rollout = rollouts[c];
+        cb_rollout_result& result = results[c];
+        result.ok = rollout.ok ? 1 : 0;
+        result.max_sinkage = rollout.maxSinkage;
+        result.wall_time = rollout.wallTime;
+        CopyState(rollout.finalState, rollout.finalTime, forward_speed(rollout.finalState), &result.final_state);
+
+        size_t samples = trajectories ? std::min(max_samples, rollout.trajectory.size()) : 0;
+        for (size_t i = 0; i < samples; i++) {
+            CopyState(rollout.trajectory[i], rollout.sampleTimes[i], forward_speed(rollout.trajectory[i]),
+                      &trajectories[c * max_samples + i]);
+        }
+        result.num_samples = (int)samples;
+    }
+    return 0;
+}
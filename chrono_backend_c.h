@@ -0,0 +1,115 @@
+/*
+ * C API of the chrono_backend library: run the vehicle-on-SCM simulation in-process.
+ *
+ * The ABI is kept stable: handles are opaque, and configuration goes through the command line
+ * syntax of the main executable, so new options never change a signature. The structs below
+ * are frozen, since callers allocate arrays of them; new data comes as new structs and
+ * functions, under a new CB_API_VERSION. Functions returning int give 0 (or a count) on success
+ * and a negative value on error; cb_last_error() then describes the error of the calling thread.
+ * No C++ exception crosses this interface.
+ *
+ * A simulation handle may be used from one thread at a time. Different handles are independent
+ * and can be stepped concurrently.
+ */
+#ifndef CHRONO_BACKEND_C_H
+#define CHRONO_BACKEND_C_H
+
+#include <stddef.h>
+
+#if defined(_WIN32)
+#define CB_API __declspec(dllexport)
+#else
+#define CB_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CB_API_VERSION 1
+
+typedef struct cb_config cb_config;
+typedef struct cb_simulation cb_simulation;
+typedef struct cb_snapshot cb_snapshot;
+
+/* Chassis state in the Chrono world frame (Z up). Frozen layout. */
+typedef struct cb_vehicle_state {
+    double time;        /* Sim time (s) */
+    double pos[3];      /* Chassis reference position (m) */
+    double rot[4];      /* Chassis orientation quaternion (w, x, y, z) */
+    double vel[3];      /* Linear velocity (m/s) */
+    double acc[3];      /* Linear acceleration (m/s^2) */
+    double ang_vel[3];  /* Angular velocity (rad/s) */
+    double speed;       /* Forward speed (m/s) */
+} cb_vehicle_state;
+
+CB_API int cb_api_version(void);
+CB_API const char* cb_last_error(void);
+
+/* Configuration. Starts from the executable defaults, but headless, without TCP or ROS, and
+ * with driver inputs set through cb_set_inputs(). */
+CB_API cb_config* cb_config_create(void);
+CB_API void cb_config_destroy(cb_config* config);
+
+/* Apply options in command line syntax, e.g. {"--step", "0.001", "--vehicles", "2"}
+ * (no program name). Options that need a network connection are accepted but unusual here. */
+CB_API int cb_config_parse_args(cb_config* config, int argc, const char* const* argv);
+
+/* Build and initialize a simulation; NULL on error */
+CB_API cb_simulation* cb_create(const cb_config* config);
+CB_API void cb_destroy(cb_simulation* sim);
+
+CB_API int cb_num_vehicles(const cb_simulation* sim);
+CB_API double cb_time(const cb_simulation* sim);
+CB_API double cb_step_size(const cb_simulation* sim);
+
+/* Inputs are held until changed: throttle and braking in [0, 1], steering in [-1, 1] */
+CB_API int cb_set_inputs(cb_simulation* sim, int vehicle, double throttle, double steering, double braking);
+
+/* Advance by a number of fixed physics steps */
+CB_API int cb_step(cb_simulation* sim, int steps);
+
+/* Copy the state of one vehicle, or of the first `capacity` vehicles, into caller memory;
+ * cb_get_states returns the number of states written, or a negative value if any could not be */
+CB_API int cb_get_state(const cb_simulation* sim, int vehicle, cb_vehicle_state* out);
+CB_API int cb_get_states(const cb_simulation* sim, cb_vehicle_state* out, size_t capacity);
+
+/* In-memory snapshot of the complete system, terrain and driver state; a snapshot can only be
+ * restored into the simulation it was saved from or one built from the same configuration */
+CB_API cb_snapshot* cb_snapshot_save(cb_simulation* sim);
+CB_API int cb_snapshot_restore(cb_simulation* sim, const cb_snapshot* snapshot);
+CB_API void cb_snapshot_destroy(cb_snapshot* snapshot);
+
+/* Rollouts: simulate candidate control sequences from the current state on worker simulations
+ * (built on first use, `workers` of them, in parallel, and rebuilt only when `workers`
+ * changes), leaving this simulation untouched.
+ * Candidate c applies segments [offset_c, offset_c + segment_counts[c]) in order, where offset_c
+ * is the sum of the previous counts, to `vehicle`. Results get one entry per candidate;
+ * trajectories, if not NULL, receive up to `max_samples` states per candidate at
+ * trajectories[c * max_samples], one every `sample_interval` seconds from the start
+ * (0 = every 0.1 s). */
+/* Frozen layouts */
+typedef struct cb_rollout_segment {
+    double duration;  /* (s) */
+    double throttle;
+    double steering;
+    double braking;
+} cb_rollout_segment;
+
+typedef struct cb_rollout_result {
+    int ok;                       /* 0 if the candidate could not run */
+    int num_samples;              /* Trajectory samples written */
+    double max_sinkage;           /* Deepest wheel sinkage of any vehicle (m) */
+    double wall_time;             /* (s) */
+    cb_vehicle_state final_state;
+} cb_rollout_result;
+
+CB_API int cb_rollout(cb_simulation* sim, int workers, int vehicle, int num_candidates, const int* segment_counts,
+                      const cb_rollout_segment* segments, double sample_interval, cb_rollout_result* results,
+                      cb_vehicle_state* trajectories, size_t max_samples);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CHRONO_BACKEND_C_H */
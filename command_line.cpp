@@ -0,0 +1,603 @@
+#include "command_line.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "trajectory_log.hpp"
+
+using namespace chrono;
+
+void printUsage() {
+    std::cout << "Usage: ./main [options]\n"
+              << "Options:\n"
+              << "  --pos x y z    : Set initial position (default: 277.39 -31.1 5.0)\n"
+              << "  --rot x y z    : Set initial rotation in degrees (default: 0 0 0)\n"
+              << "  --z-offset val : Set unreal Z offset (default: 2.3)\n"
+              << "  --no-viz       : Run without visualization\n"
+              << "  --async-render : Render on a separate thread from double-buffered transforms\n"
+              << "  --record-inputs f : Record every step's driver inputs, step size and solver cap to f\n"
+              << "  --replay-inputs f : Drive from a recorded input trace, reproducing the run exactly\n"
+              << "  --vehicles n   : Simulate n vehicles on the shared terrain (/robot0../robot<n-1>)\n"
+              << "  --vehicle-spacing x y z : Offset between vehicle start positions (default: 0 6 0)\n"
+              << "  --vehicle-threads n : Threads for per-vehicle work (default: one per vehicle)\n"
+              << "  --spawn-pool n : Pre-build n parked vehicles for CreateUnit packets (default: 0)\n"
+              << "  --lod          : Run vehicles far from vehicle 0 on a kinematic bicycle model\n"
+              << "  --lod-radius r : Distance to vehicle 0 within which vehicles use the full model (default: 60)\n"
+              << "  --watchdog     : Roll back to a checkpoint with a smaller step on divergence\n"
+              << "  --checkpoint-interval s : Sim time between watchdog checkpoints (default: 0.5)\n"
+              << "  --lockstep     : Advance only on client StepRequest packets over TCP\n"
+              << "  --first-unit-id n : TCP unit id of vehicle 0, the others follow (default: 123)\n"
+              << "  --regions n    : Split the terrain along X into n strips, one process each\n"
+              << "  --region k     : Strip simulated by this process (default: 0); it starts the vehicles\n"
+              << "                   whose start position is in the strip and hands those leaving it to\n"
+              << "                   the neighbour. Use the same fleet options in every region; the spawn\n"
+              << "                   pool is split between regions\n"
+              << "  --region-port p: UDP port of region 0, region k uses p + k (default: 17900)\n"
+              << "  --region-hosts l: Comma-separated address of each region (default: 127.0.0.1)\n"
+              << "  --ghost-margin m: Mirror vehicles within m of a border to the neighbour (default: 20)\n"
+              << "  --system b     : Multibody system backend: nsc (Bullet collision) or multicore\n"
+              << "                   (Chrono::Multicore collision and solver, no --watchdog) (default: nsc)\n"
+              << "  --compare-backends : Run the scripted maneuver headless for --duration s (default 10)\n"
+              << "                   on every available backend, report throughput and trajectory deviation\n"
+              << "  --explicit-coupling : Step SCM terrain concurrently with one-step-lagged forces\n"
+              << "  --terrain-node a: Explicit coupling with SCM in a terrain process at a (host:port or\n"
+              << "                   unix:/path), started with --serve-terrain a and the same terrain options;\n"
+              << "                   not with --watchdog or --lockstep, which restore snapshots\n"
+              << "  --serve-terrain a: Run only the SCM terrain for one vehicle process connecting to a\n"
+              << "  --no-tcp       : Do not wait for a TCP client or stream poses\n"
+              << "  --tcp-port n   : Port of the UE / lockstep client connection (default: 17863)\n"
+              << "  --no-ros       : Do not connect to rosbridge (implies --scripted-driver)\n"
+              << "  --ros-prefix p : Prepend p to every ROS topic, e.g. /sim1/robot0/cmd_vel (default: none;\n"
+              << "                   server sessions get /sim<client port>)\n"
+              << "  --scripted-driver : Drive with the built-in scripted maneuver\n"
+              << "  --duration s   : Stop after s seconds of sim time\n"
+              << "  --trajectory-log f : Write the chassis trajectory to CSV file f\n"
+              << "  --compare-trajectories ref cand : Report deviation of cand from ref and exit\n"
+              << "  --free-run     : Run as fast as possible and publish /clock\n"
+              << "  --clock-rate hz: Set /clock publish rate in sim time (default: 100)\n"
+              << "  --adaptive-step: Vary the timestep with solver convergence and RTF\n"
+              << "  --target-rtf v : Target RTF (wall/sim time) for the adaptive step (default: 1.0)\n"
+              << "  --qos          : Shed render/sensor/pose/solver work when behind wall clock\n"
+              << "  --qos-order l  : Comma-separated shedding order (default: render,pose,sensors,solver)\n"
+              << "  --substeps n   : Physics steps per I/O cycle (default: 1)\n"
+              << "  --pose-rate hz : TCP pose stream rate, 0 = every I/O cycle (default: 0)\n"
+              << "  --telemetry s  : Log a [Telemetry] line every s seconds of sim time (default: off)\n"
+              << "  --realtime     : Low-jitter pacing with deadline-miss accounting\n"
+              << "  --rt-priority n: SCHED_FIFO priority of the physics thread (implies --realtime)\n"
+              << "  --rt-cpu n     : Pin the physics thread to CPU n (implies --realtime)\n"
+              << "  --rt-mlock     : Lock process memory with mlockall (implies --realtime)\n"
+              << "  --physics-cpus l: CPUs for the physics thread and Chrono pools, e.g. 0-3\n"
+              << "  --io-cpus l    : CPUs for ROS bridge and other I/O threads\n"
+              << "  --render-cpus l: CPUs for the render thread\n"
+              << "  --chrono-threads n   : Chrono/OpenMP threads (default: size of physics CPU set)\n"
+              << "  --collision-threads n: Collision detection threads\n"
+              << "  --server port  : Host many sessions; other options become session defaults\n"
+              << "                   (control socket on localhost: create <options>, stop <id>, list, shutdown)\n"
+              << "  --max-sessions n: Sessions running at once in server mode (default: 4)\n"
+              << "  --batch B      : Step B headless copies in-process for --duration s (default 10) and\n"
+              << "                   report sample throughput\n"
+              << "  --warm-pool k  : Keep k initialized default sessions ready in server mode; they use\n"
+              << "                   the k + max-sessions client ports from --tcp-port on, other sessions\n"
+              << "                   get ports above them (default: 0)\n"
+              << "  --sweep f      : Run every combination of the parameter grid in f headless for\n"
+              << "                   --duration s (default 10) and write one summary row per case\n"
+              << "                   (grid lines: <parameter> <values...>; parameters: soilKphi, soilKc,\n"
+              << "                   soilN, soilCohesion, soilFriction, soilJanosi, soilStiffness,\n"
+              << "                   soilDamping, stepSize, terrainDelta)\n"
+              << "  --sweep-out f  : Summary CSV of the sweep (default: sweep_results.csv)\n"
+              << "  --sweep-workers n: Sweep cases run at once (default: one per hardware thread)\n";
+}
+
+// Add this helper function to convert degrees to radians
+double degToRad(double deg) {
+    return deg * CH_PI / 180.0;
+}
+
+// Add this helper function to convert Euler angles to quaternion
+ChQuaternion<> eulerToQuaternion(double roll, double pitch, double yaw) {
+    // Convert degrees to radians
+    roll = degToRad(roll);
+    pitch = degToRad(pitch);
+    yaw = degToRad(yaw);
+    
+    // Create quaternion and set it using sequential rotations
+    ChQuaternion<> q(1, 0, 0, 0);
+    ChQuaternion<> qZ;
+    ChQuaternion<> qY;
+    ChQuaternion<> qX;
+    
+    qZ.SetFromAngleZ(yaw);
+    qY.SetFromAngleY(pitch);
+    qX.SetFromAngleX(roll);
+    
+    // Combine rotations: first roll (X), then pitch (Y), then yaw (Z)
+    q = qZ * qY * qX;
+    return q;
+}
+
+int ParseArguments(int argc, char* argv[], ChronoSimulation::Config& config,
+                          ThreadBudget::Settings& thread_budget, SimulationServer::Settings& server,
+                          BatchEnvironment::Settings& batch, SweepRunner::Settings& sweep) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        
+        if (arg == "--pos" && i + 3 < argc) {
+            try {
+                double x = std::stod(argv[i + 1]);
+                double y = std::stod(argv[i + 2]);
+                double z = std::stod(argv[i + 3]);
+                config.initLoc = ChVector3d(x, y, z);
+                i += 3;
+            } catch (const std::exception& e) {
+                std::cerr << "Error parsing position arguments\n";
+                printUsage();
+                return 1;
+            }
+        }
+        else if (arg == "--rot" && i + 3 < argc) {
+            try {
+                double roll = std::stod(argv[i + 1]);
+                double pitch = std::stod(argv[i + 2]);
+                double yaw = std::stod(argv[i + 3]);
+                config.initRot = eulerToQuaternion(roll, pitch, yaw);
+                i += 3;
+            } catch (const std::exception& e) {
+                std::cerr << "Error parsing rotation arguments\n";
+                printUsage();
+                return 1;
+            }
+        }
+        else if (arg == "--z-offset" && i + 1 < argc) {
+            try {
+                float zOffset = std::stof(argv[i + 1]);
+                config.unrealZOfsset = zOffset;
+                i += 1;
+                std::cout << "Setting Unreal Z offset to: " << zOffset << std::endl;
+            } catch (const std::exception& e) {
+                std::cerr << "Error parsing Z offset argument\n";
+                printUsage();
+                return 1;
+            }
+        }
+        else if (arg == "--no-viz") {
+            config.useVisualization = false;
+            std::cout << "Running without visualization" << std::endl;
+        }
+        else if (arg == "--async-render") {
+            config.asyncRender = true;
+        }
+        else if (arg == "--record-inputs" && i + 1 < argc) {
+            config.recordInputsFile = argv[i + 1];
+            i += 1;
+        }
+        else if (arg == "--replay-inputs" && i + 1 < argc) {
+            config.replayInputsFile = argv[i + 1];
+            i += 1;
+        }
+        else if (arg == "--vehicles" && i + 1 < argc) {
+            try {
+                config.numVehicles = std::max(1, std::stoi(argv[i + 1]));
+                i += 1;
+            } catch (const std::exception& e) {
+                std::cerr << "Error parsing vehicles argument\n";
+                printUsage();
+                return 1;
+            }
+        }
+        else if (arg == "--vehicle-spacing" && i + 3 < argc) {
+            try {
+                config.vehicleSpacing = ChVector3d(std::stod(argv[i + 1]), std::stod(argv[i + 2]), std::stod(argv[i + 3]));
+                i += 3;
+            } catch (const std::exception& e) {
+                std::cerr << "Error parsing vehicle spacing arguments\n";
+                printUsage();
+                return 1;
+            }
+        }
+        else if (arg == "--vehicle-threads" && i + 1 < argc) {
+            try {
+                config.vehicleThreads = std::stoi(argv[i + 1]);
+                i += 1;
+            } catch (const std::exception& e) {
+                std::cerr << "Error parsing vehicle threads argument\n";
+                printUsage();
+                return 1;
+            }
+        }
+        else if (arg == "--spawn-pool" && i + 1 < argc) {
+            try {
+                config.spawnPoolSize = std::stoi(argv[i + 1]);
+                i += 1;
+            } catch (const std::exception& e) {
+                std::cerr << "Error parsing spawn pool argument\n";
+                printUsage();
+                return 1;
+            }
+        }
+        else if (arg == "--lod") {
+            config.vehicleLod = true;
+        }
+        else if (arg == "--lod-radius" && i + 1 < argc) {
+            try {
+                config.lodSettings.promoteRadius = std::stod(argv[i + 1]);
+                config.lodSettings.demoteRadius = 1.25 * config.lodSettings.promoteRadius;
+                i += 1;
+            } catch (const std::exception& e) {
+                std::cerr << "Error parsing LOD radius argument\n";
+                printUsage();
+                return 1;
+            }
+        }
+        else if (arg == "--watchdog") {
+            config.watchdog = true;
+        }
+        else if (arg == "--checkpoint-interval" && i + 1 < argc) {
+            try {
+                config.watchdogSettings.checkpointInterval = std::stod(argv[i + 1]);
+                i += 1;
+            } catch (const std::exception& e) {
+                std::cerr << "Error parsing checkpoint interval argument\n";
+                printUsage();
+                return 1;
+            }
+        }
+        else if (arg == "--lockstep") {
+            config.lockstep = true;
+        }
+        else if (arg == "--first-unit-id" && i + 1 < argc) {
+            try {
+                config.firstUnitId = std::stoi(argv[i + 1]);
+                i += 1;
+            } catch (const std::exception& e) {
+                std::cerr << "Error parsing first unit id argument\n";
+                printUsage();
+                return 1;
+            }
+        }
+        else if (arg == "--regions" && i + 1 < argc) {
+            try {
+                config.regionSettings.regions = std::max(1, std::stoi(argv[i + 1]));
+                i += 1;
+            } catch (const std::exception& e) {
+                std::cerr << "Error parsing regions argument\n";
+                printUsage();
+                return 1;
+            }
+        }
+        else if (arg == "--region" && i + 1 < argc) {
+            try {
+                config.regionSettings.index = std::stoi(argv[i + 1]);
+                i += 1;
+            } catch (const std::exception& e) {
+                std::cerr << "Error parsing region argument\n";
+                printUsage();
+                return 1;
+            }
+        }
+        else if (arg == "--region-port" && i + 1 < argc) {
+            try {
+                config.regionSettings.basePort = std::stoi(argv[i + 1]);
+                i += 1;
+            } catch (const std::exception& e) {
+                std::cerr << "Error parsing region port argument\n";
+                printUsage();
+                return 1;
+            }
+        }
+        else if (arg == "--region-hosts" && i + 1 < argc) {
+            config.regionSettings.hosts.clear();
+            std::stringstream ss(argv[i + 1]);
+            std::string host;
+            while (std::getline(ss, host, ',')) {
+                if (!host.empty()) config.regionSettings.hosts.push_back(host);
+            }
+            if (config.regionSettings.hosts.empty()) {
+                std::cerr << "Error parsing region hosts argument\n";
+                printUsage();
+                return 1;
+            }
+            i += 1;
+        }
+        else if (arg == "--ghost-margin" && i + 1 < argc) {
+            try {
+                config.regionSettings.ghostMargin = std::stod(argv[i + 1]);
+                i += 1;
+            } catch (const std::exception& e) {
+                std::cerr << "Error parsing ghost margin argument\n";
+                printUsage();
+                return 1;
+            }
+        }
+        else if (arg == "--terrain-node" && i + 1 < argc) {
+            config.terrainNode = argv[i + 1];
+            config.explicitCoupling = true;
+            i += 1;
+        }
+        else if (arg == "--serve-terrain" && i + 1 < argc) {
+            config.terrainNode = argv[i + 1];
+            config.serveTerrain = true;
+            i += 1;
+        }
+        else if (arg == "--system" && i + 1 < argc) {
+            std::string backend = argv[i + 1];
+            if (backend == "nsc") {
+                config.systemBackend = ChronoSimulation::SystemBackend::NSC;
+            } else if (backend == "multicore") {
+                config.systemBackend = ChronoSimulation::SystemBackend::MULTICORE;
+            } else {
+                std::cerr << "Unknown system backend " << backend << "\n";
+                printUsage();
+                return 1;
+            }
+            if (!ChronoSimulation::IsBackendAvailable(config.systemBackend)) {
+                std::cerr << "System backend " << backend << " is not in this build (needs Chrono::Multicore)\n";
+                return 1;
+            }
+            i += 1;
+        }
+        else if (arg == "--compare-backends") {
+            config.compareBackends = true;
+        }
+        else if (arg == "--explicit-coupling") {
+            config.explicitCoupling = true;
+        }
+        else if (arg == "--tcp-port" && i + 1 < argc) {
+            try {
+                config.tcpPort = std::stoi(argv[i + 1]);
+                i += 1;
+            } catch (const std::exception& e) {
+                std::cerr << "Error parsing TCP port argument\n";
+                printUsage();
+                return 1;
+            }
+        }
+        else if (arg == "--no-tcp") {
+            config.useTcpServer = false;
+        }
+        else if (arg == "--no-ros") {
+            config.useRos = false;
+        }
+        else if (arg == "--ros-prefix" && i + 1 < argc) {
+            config.rosPrefix = argv[i + 1];
+            if (!config.rosPrefix.empty() && config.rosPrefix.front() != '/') {
+                config.rosPrefix.insert(0, "/");
+            }
+            while (!config.rosPrefix.empty() && config.rosPrefix.back() == '/') {
+                config.rosPrefix.pop_back();
+            }
+            i += 1;
+        }
+        else if (arg == "--scripted-driver") {
+            config.scriptedDriver = true;
+        }
+        else if (arg == "--duration" && i + 1 < argc) {
+            try {
+                config.duration = std::stod(argv[i + 1]);
+                i += 1;
+            } catch (const std::exception& e) {
+                std::cerr << "Error parsing duration argument\n";
+                printUsage();
+                return 1;
+            }
+        }
+        else if (arg == "--trajectory-log" && i + 1 < argc) {
+            config.trajectoryFile = argv[i + 1];
+            i += 1;
+        }
+        else if (arg == "--compare-trajectories" && i + 2 < argc) {
+            return TrajectoryLog::Compare(argv[i + 1], argv[i + 2], std::cout) ? 0 : 1;
+        }
+        else if (arg == "--free-run") {
+            config.freeRun = true;
+            std::cout << "Running in free-run mode (no realtime pacing)" << std::endl;
+        }
+        else if (arg == "--clock-rate" && i + 1 < argc) {
+            try {
+                config.clockRate = std::stod(argv[i + 1]);
+                i += 1;
+            } catch (const std::exception& e) {
+                std::cerr << "Error parsing clock rate argument\n";
+                printUsage();
+                return 1;
+            }
+        }
+        else if (arg == "--adaptive-step") {
+            config.adaptiveStep = true;
+            std::cout << "Adaptive timestep enabled" << std::endl;
+        }
+        else if (arg == "--target-rtf" && i + 1 < argc) {
+            try {
+                config.targetRTF = std::stod(argv[i + 1]);
+                i += 1;
+            } catch (const std::exception& e) {
+                std::cerr << "Error parsing target RTF argument\n";
+                printUsage();
+                return 1;
+            }
+        }
+        else if (arg == "--qos") {
+            config.qosGovernor = true;
+            std::cout << "QoS governor enabled" << std::endl;
+        }
+        else if (arg == "--qos-order" && i + 1 < argc) {
+            std::vector<QosGovernor::Knob> order;
+            std::stringstream ss(argv[i + 1]);
+            std::string name;
+            while (std::getline(ss, name, ',')) {
+                QosGovernor::Knob knob;
+                if (!QosGovernor::ParseKnob(name, knob)) {
+                    std::cerr << "Unknown QoS knob: " << name << "\n";
+                    printUsage();
+                    return 1;
+                }
+                order.push_back(knob);
+            }
+            config.qosSettings.order = order;
+            i += 1;
+        }
+        else if (arg == "--substeps" && i + 1 < argc) {
+            try {
+                config.physicsSubsteps = std::max(1, std::stoi(argv[i + 1]));
+                i += 1;
+            } catch (const std::exception& e) {
+                std::cerr << "Error parsing substeps argument\n";
+                printUsage();
+                return 1;
+            }
+        }
+        else if (arg == "--pose-rate" && i + 1 < argc) {
+            try {
+                config.poseRate = std::stod(argv[i + 1]);
+                i += 1;
+            } catch (const std::exception& e) {
+                std::cerr << "Error parsing pose rate argument\n";
+                printUsage();
+                return 1;
+            }
+        }
+        else if (arg == "--telemetry" && i + 1 < argc) {
+            try {
+                config.telemetryPeriod = std::stod(argv[i + 1]);
+                i += 1;
+            } catch (const std::exception& e) {
+                std::cerr << "Error parsing telemetry argument\n";
+                printUsage();
+                return 1;
+            }
+        }
+        else if (arg == "--realtime") {
+            config.realtimeMode = true;
+        }
+        else if ((arg == "--rt-priority" || arg == "--rt-cpu") && i + 1 < argc) {
+            try {
+                int value = std::stoi(argv[i + 1]);
+                if (arg == "--rt-priority") {
+                    config.realtimeSettings.priority = value;
+                } else {
+                    config.realtimeSettings.cpu = value;
+                }
+                config.realtimeMode = true;
+                i += 1;
+            } catch (const std::exception& e) {
+                std::cerr << "Error parsing " << arg << " argument\n";
+                printUsage();
+                return 1;
+            }
+        }
+        else if (arg == "--rt-mlock") {
+            config.realtimeSettings.lockMemory = true;
+            config.realtimeMode = true;
+        }
+        else if ((arg == "--physics-cpus" || arg == "--io-cpus" || arg == "--render-cpus") && i + 1 < argc) {
+            std::vector<int>& cpus = arg == "--physics-cpus" ? thread_budget.physicsCpus
+                                   : arg == "--io-cpus"      ? thread_budget.ioCpus
+                                                             : thread_budget.renderCpus;
+            if (!ThreadBudget::ParseCpuList(argv[i + 1], cpus)) {
+                std::cerr << "Error parsing " << arg << " argument\n";
+                printUsage();
+                return 1;
+            }
+            i += 1;
+        }
+        else if ((arg == "--chrono-threads" || arg == "--collision-threads") && i + 1 < argc) {
+            try {
+                int threads = std::stoi(argv[i + 1]);
+                if (arg == "--chrono-threads") {
+                    thread_budget.chronoThreads = threads;
+                } else {
+                    thread_budget.collisionThreads = threads;
+                }
+                i += 1;
+            } catch (const std::exception& e) {
+                std::cerr << "Error parsing " << arg << " argument\n";
+                printUsage();
+                return 1;
+            }
+        }
+        else if (arg == "--server" && i + 1 < argc) {
+            try {
+                server.port = std::stoi(argv[i + 1]);
+                i += 1;
+            } catch (const std::exception& e) {
+                std::cerr << "Error parsing server port argument\n";
+                printUsage();
+                return 1;
+            }
+        }
+        else if (arg == "--max-sessions" && i + 1 < argc) {
+            try {
+                server.maxSessions = std::stoi(argv[i + 1]);
+                i += 1;
+            } catch (const std::exception& e) {
+                std::cerr << "Error parsing max sessions argument\n";
+                printUsage();
+                return 1;
+            }
+        }
+        else if (arg == "--warm-pool" && i + 1 < argc) {
+            try {
+                server.warmPool = std::stoi(argv[i + 1]);
+                i += 1;
+            } catch (const std::exception& e) {
+                std::cerr << "Error parsing warm pool argument\n";
+                printUsage();
+                return 1;
+            }
+        }
+        else if (arg == "--batch" && i + 1 < argc) {
+            try {
+                batch.numEnvs = std::stoi(argv[i + 1]);
+                i += 1;
+            } catch (const std::exception& e) {
+                std::cerr << "Error parsing batch argument\n";
+                printUsage();
+                return 1;
+            }
+        }
+        else if (arg == "--sweep" && i + 1 < argc) {
+            sweep.gridFile = argv[i + 1];
+            i += 1;
+        }
+        else if (arg == "--sweep-out" && i + 1 < argc) {
+            sweep.outputFile = argv[i + 1];
+            i += 1;
+        }
+        else if (arg == "--sweep-workers" && i + 1 < argc) {
+            try {
+                sweep.workers = std::stoi(argv[i + 1]);
+                i += 1;
+            } catch (const std::exception& e) {
+                std::cerr << "Error parsing sweep workers argument\n";
+                printUsage();
+                return 1;
+            }
+        }
+        else if (arg == "--help" || arg == "-h") {
+            printUsage();
+            return 0;
+        }
+    }
+    const RegionExchange::Settings& regions = config.regionSettings;
+    if (regions.index < 0 || regions.index >= regions.regions) {
+        std::cerr << "Region " << regions.index << " is not one of the " << regions.regions << " regions\n";
+        return 1;
+    }
+    // The watchdog reads the residual of the NSC iterative solver, which Multicore does not use
+    if (config.watchdog && config.systemBackend == ChronoSimulation::SystemBackend::MULTICORE) {
+        std::cerr << "--watchdog is not available with --system multicore\n";
+        return 1;
+    }
+    // Both restore snapshots, which cannot carry the terrain of a terrain node
+    if (!config.terrainNode.empty() && !config.serveTerrain && (config.watchdog || config.lockstep)) {
+        std::cerr << "--watchdog and --lockstep cannot be combined with --terrain-node\n";
+        return 1;
+    }
+    // Checked here so a bad trace is an argument error rather than a failure after the vehicles are built
+    if (!config.replayInputsFile.empty() && !std::ifstream(config.replayInputsFile)) {
+        std::cerr << "Cannot read input trace " << config.replayInputsFile << "\n";
+        return 1;
+    }
+    return -1;
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "main.h"
+#include "thread_budget.hpp"
+#include "simulation_server.hpp"
+#include "batch_environment.hpp"
+#include "sweep_runner.hpp"
+
+// Command line of the main executable, also used for server sessions and the C API
+void printUsage();
+
+// Apply command line arguments (argv[0] is skipped) to the configuration.
+// Returns -1 to go on, otherwise the exit code.
+int ParseArguments(int argc, char* argv[], ChronoSimulation::Config& config,
+                   ThreadBudget::Settings& thread_budget, SimulationServer::Settings& server,
+                   BatchEnvironment::Settings& batch, SweepRunner::Settings& sweep);
@@ -0,0 +1,96 @@
+#include "input_trace.hpp"
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+bool InputRecorder::Open(const std::string& filename) {
+    file_.open(filename);
+    if (!file_) {
+        std::cerr << "Cannot open input trace " << filename << std::endl;
+        return false;
+    }
+    file_ << "# unit time step max_iterations throttle steering braking" << std::endl;
+    std::cout << "Recording inputs to " << filename << std::endl;
+    return true;
+}
+
+void InputRecorder::WriteLine(const InputRecord& r) {
+    file_ << r.unit << ' ' << std::hexfloat << r.time << ' ' << r.step << ' ' << std::dec << r.maxIterations << ' '
+          << std::hexfloat << r.throttle << ' ' << r.steering << ' ' << r.braking << '\n';
+}
+
+void InputRecorder::Record(const InputRecord& record) {
+    if (!file_.is_open()) return;
+
+    auto it = units_.find(record.unit);
+    const InputRecord* last = it != units_.end() ? &it->second.last : nullptr;
+    bool changed = !last || record.step != last->step || record.maxIterations != last->maxIterations ||
+                   record.throttle != last->throttle || record.steering != last->steering ||
+                   record.braking != last->braking;
+    if (changed) {
+        WriteLine(record);
+    }
+    units_[record.unit] = {record, changed};
+}
+
+void InputRecorder::Close() {
+    if (!file_.is_open()) return;
+    for (const auto& unit : units_) {
+        if (!unit.second.written) {
+            WriteLine(unit.second.last);
+        }
+    }
+    file_.close();
+}
+
+ReplayDriver::ReplayDriver(chrono::vehicle::ChVehicle& vehicle) : ChDriver(vehicle), index_(0) {}
+
+bool ReplayDriver::Load(const std::string& filename, int unit) {
+    std::ifstream file(filename);
+    if (!file) {
+        std::cerr << "Cannot open input trace " << filename << std::endl;
+        return false;
+    }
+
+    // operator>> does not parse hexfloats, strtod does
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream ss(line);
+        int record_unit;
+        std::string time, step, iterations, throttle, steering, braking;
+        if (!(ss >> record_unit >> time >> step >> iterations >> throttle >> steering >> braking)) {
+            std::cerr << "Malformed input trace line: " << line << std::endl;
+            return false;
+        }
+        if (record_unit != unit) continue;
+        records_.push_back({record_unit, std::strtod(time.c_str(), nullptr), std::strtod(step.c_str(), nullptr),
+                            std::atoi(iterations.c_str()), std::strtod(throttle.c_str(), nullptr),
+                            std::strtod(steering.c_str(), nullptr), std::strtod(braking.c_str(), nullptr)});
+    }
+
+    if (records_.empty()) {
+        std::cerr << "Input trace " << filename << " has no records for unit " << unit << std::endl;
+        return false;
+    }
+    std::cout << "Replaying " << records_.size() << " input records of unit " << unit << " from " << filename << " (until t="
+              << records_.back().time << ")" << std::endl;
+    return true;
+}
+
+const InputRecord& ReplayDriver::Seek(double time) {
+    // Times repeat exactly on replay, so the record in effect is the last one not after `time`.
+    // The cursor only moves forward: after a watchdog rollback the trace continues with the
+    // retry record, which was written at the (earlier) checkpoint time.
+    while (index_ + 1 < records_.size() && records_[index_ + 1].time <= time) {
+        index_++;
+    }
+
+    const InputRecord& record = records_[index_];
+    m_throttle = record.throttle;
+    m_steering = record.steering;
+    m_braking = record.braking;
+    return record;
+}
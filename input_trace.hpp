@@ -0,0 +1,63 @@
+#pragma once
+
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "chrono_vehicle/ChDriver.h"
+
+// One entry of an input trace: everything that feeds into a physics step besides the state
+// itself. Values are stored as hexfloats so a replay reproduces them bit for bit.
+struct InputRecord {
+    int unit;           // Vehicle unit id the driver inputs belong to
+    double time;        // Sim time at the start of the step
+    double step;        // Step size used for it
+    int maxIterations;  // Solver iteration cap in effect
+    double throttle;
+    double steering;
+    double braking;
+};
+
+// Writes the inputs of every physics step, one stream per vehicle unit. A line is only written
+// when something changed for that unit, and the last step of every unit is always written on
+// Close() so the trace covers the whole run.
+class InputRecorder {
+public:
+    ~InputRecorder() { Close(); }
+
+    bool Open(const std::string& filename);
+    void Record(const InputRecord& record);
+    void Close();
+
+private:
+    void WriteLine(const InputRecord& record);
+
+    struct UnitState {
+        InputRecord last;
+        bool written;
+    };
+
+    std::ofstream file_;
+    std::map<int, UnitState> units_;
+};
+
+// Feeds the recorded inputs of one unit back into its vehicle. The simulation calls Seek() with
+// the time of each step before reading the inputs; the primary unit's records also supply the
+// step size and solver cap.
+class ReplayDriver : public chrono::vehicle::ChDriver {
+public:
+    ReplayDriver(chrono::vehicle::ChVehicle& vehicle);
+
+    bool Load(const std::string& filename, int unit);
+
+    // Apply the record in effect at this sim time and return it
+    const InputRecord& Seek(double time);
+
+    // True once the trace has been played past its last record
+    bool Finished(double time) const { return records_.empty() || time > records_.back().time; }
+
+private:
+    std::vector<InputRecord> records_;
+    size_t index_;
+};
@@ -1,14 +1,24 @@
 #include "main.h"
-#include "simulation_launcher.h"
+#include "thread_budget.hpp"
 #include <chrono>
 #include <thread>
+#include <sstream>
+#include <set>
+#include <cstring>
+#include <stdexcept>
 #include "chrono/core/ChRealtimeStep.h"
+#ifdef CHRONO_BACKEND_MULTICORE
+#include "chrono_multicore/physics/ChSystemMulticore.h"
+#endif
 
 using namespace chrono;
 using namespace chrono::vehicle;
 using namespace chrono::vehicle::generic;
 using namespace chrono::vehicle::hmmwv;
 
+// Pool vehicles wait this far (m) below their start position, out of sight and out of SCM's reach
+static const double kParkingDepth = 50.0;
+
 // Implementation of MyDriver methods
 MyDriver::MyDriver(ChVehicle& vehicle, double delay) : ChDriver(vehicle), m_delay(delay) {}
 
@@ -34,6 +44,14 @@ void MyDriver::Synchronize(double time) {
         m_steering = 0.6 * std::sin(CH_2PI * (eff_time - 2) / 6);
 }
 
+ExternalDriver::ExternalDriver(ChVehicle& vehicle) : ChDriver(vehicle) {}
+
+void ExternalDriver::SetInputs(double throttle, double steering, double braking) {
+    SetThrottle(std::clamp(throttle, 0.0, 1.0));
+    SetSteering(std::clamp(steering, -1.0, 1.0));
+    SetBraking(std::clamp(braking, 0.0, 1.0));
+}
+
 // ChronoSimulation::Config implementation
 ChronoSimulation::Config::Config() :
     patchType(PatchType::HEIGHTMAP),
@@ -41,10 +59,47 @@ ChronoSimulation::Config::Config() :
     renderStepSize(1.0 / 100),
     renderWireframe(false),
     driverDelay(0.5),
+    adaptiveStep(false),
+    minStepSize(1e-3),
+    maxStepSize(1e-2),
+    targetRTF(1.0),
+    maxSolverResidual(1e-2),
+    contactSpikeRatio(2.0),
+    solverMaxIterations(150),
+    qosGovernor(false),
+    sensorRate(50.0),
+    physicsSubsteps(1),
+    poseRate(0.0),
+    telemetryPeriod(0),
+    realtimeMode(false),
     initLoc(ChVector3d(277.39,-31.1, 5.0)),
     initRot(ChQuaternion<>(1, 0, 0, 0)),
+    numVehicles(1),
+    vehicleSpacing(ChVector3d(0, 6, 0)),
+    firstUnitId(123),
+    vehicleThreads(0),
+    spawnPoolSize(0),
+    spawnClearance(1.0),
+    vehicleLod(false),
     useTerrainMesh(true),
     useVisualization(true),
+    asyncRender(false),
+    explicitCoupling(false),
+    serveTerrain(false),
+    systemBackend(SystemBackend::NSC),
+    compareBackends(false),
+    useTcpServer(true),
+    tcpPort(17863),
+    useRos(true),
+    rosPrefix(""),
+    scriptedDriver(false),
+    duration(0),
+    trajectoryRate(10.0),
+    lockstep(false),
+    externalInputs(false),
+    watchdog(false),
+    freeRun(false),
+    clockRate(100.0),
     patchSize(ChVector2d(10.0, 10.0)),
     heightmapFile("../heightmap.bmp"),
     terrainHeight(300),
@@ -65,7 +120,30 @@ ChronoSimulation::Config::Config() :
 {}
 
 // ChronoSimulation implementation
-ChronoSimulation::ChronoSimulation(const Config& config) : m_config(config), m_system(nullptr), m_tcp_server(17863) {
+ChronoSimulation::ChronoSimulation(const Config& config)
+    : m_config(config),
+      m_system(nullptr),
+      m_renderTask(-1),
+      m_ioReader(nullptr),
+      m_ioRunning(false),
+      m_sensorPeriod(0),
+      m_posePeriod(0),
+      m_sensorTask(-1),
+      m_poseTask(-1),
+      m_stepCount(0),
+      m_serveSnapshotRequests(false),
+      m_snapshotRequested(false),
+      m_clientConnected(true),
+      m_stopRequested(false),
+      m_publishedTime(0),
+      m_targetRTF(config.targetRTF),
+      m_stepSize(config.stepSize),
+      m_avgContactEvents(0),
+      m_convergedSteps(0) {
+}
+
+ChronoSimulation::~ChronoSimulation() {
+    StopIo();
 }
 
 void ChronoSimulation::Initialize() {
@@ -77,61 +155,442 @@ void ChronoSimulation::Initialize() {
         m_config.unrealZOfsset,
         m_config.corner);
 
+    // The strips divide the heightmap, which every region loads centered on the origin. Set up
+    // before the vehicles, which are only activated in the region their start position is in.
+    if (m_config.regionSettings.regions > 1) {
+        m_regions = std::make_shared<RegionExchange>(m_config.regionSettings, -0.5 * m_config.terrainHeight,
+                                                     0.5 * m_config.terrainHeight);
+        if (!m_regions->Open()) {
+            throw std::runtime_error("Cannot open the exchange socket of region " +
+                                     std::to_string(m_config.regionSettings.index));
+        }
+    }
+
     SetupVehicle();
+
+    // In explicit coupling mode SCM lives in a separate system driven by wheel proxies
+    if (m_config.explicitCoupling || !m_config.terrainNode.empty()) {
+        std::vector<ChWheeledVehicle*> vehicles;
+        for (auto& unit : m_units) {
+            vehicles.push_back(unit.vehicle.get());
+        }
+        m_coupling = std::make_shared<TerrainCoupling>(vehicles, m_config.terrainNode);
+    }
     
     // Setup terrain
     SetupTerrain();
 
-    SetupSensors();
-    // Setup visualization only if enabled
-    if (m_config.useVisualization) {
+    // The primary vehicle is the point of interest and always runs the full model
+    if (m_config.vehicleLod) {
+        for (size_t i = 1; i < m_units.size(); i++) {
+            m_units[i].lod = std::make_shared<VehicleLod>(m_units[i].vehicle.get(), m_units[i].bodies, m_terrain,
+                                                          m_config.lodSettings);
+        }
+    }
+
+    if (m_config.useTcpServer || m_config.lockstep) {
+        m_tcp_server = std::make_shared<TcpPositionServer>(m_config.tcpPort);
+    }
+
+    if (m_config.useRos) {
+        SetupSensors();
+    }
+    // Setup inline visualization only if enabled; the async renderer is built once the system is complete
+    if (m_config.useVisualization && !m_config.asyncRender) {
         SetupVisualization();
     }
     
-    // Create driver
-    m_driver = std::make_shared<ROSDriver>(*m_vehicle,20,.95);
-    m_driver->Initialize();
+    SetupDrivers();
+
+    if (!m_config.recordInputsFile.empty()) {
+        m_recorder = std::make_shared<InputRecorder>();
+        if (!m_recorder->Open(m_config.recordInputsFile)) {
+            m_recorder.reset();
+        }
+    }
     
     // Get system pointer (owned by the vehicle, do not delete)
     m_system = m_vehicle->GetSystem();
     
-    // Configure solver
-    m_system->SetSolverType(ChSolver::Type::BARZILAIBORWEIN);
-    m_system->GetSolver()->AsIterative()->SetMaxIterations(150);
+    // Size Chrono's thread pools to the process thread budget
+    ThreadBudget::ApplyToSystem(m_system);
+
+    // Configure solver; Multicore brings its own, set up in CreateMulticoreSystem()
+    if (!m_backendSystem) {
+        m_system->SetSolverType(ChSolver::Type::BARZILAIBORWEIN);
+    }
+    SetSolverMaxIterations(m_config.solverMaxIterations);
+
+    if (m_config.useVisualization && m_config.asyncRender) {
+        AsyncRenderer::Settings render_settings;
+        render_settings.terrainDelta = m_config.terrainDelta;
+        render_settings.wireframe = m_config.renderWireframe;
+        render_settings.terrainTexture = "../mapchrono.png";
+        m_renderer = std::make_shared<AsyncRenderer>(m_system, m_terrain, m_vehicle->GetChassisBody(), render_settings);
+    }
+
+    if (m_config.qosGovernor) {
+        m_qos = std::make_shared<QosGovernor>(m_config.qosSettings);
+    }
+
+    if (m_config.watchdog) {
+        m_watchdog = std::make_shared<StabilityWatchdog>(m_config.watchdogSettings);
+    }
+    // Per-vehicle synchronize/advance runs in parallel; the shared system is stepped once
+    if (m_units.size() > 1) {
+        int threads = m_config.vehicleThreads > 0 ? m_config.vehicleThreads : (int)m_units.size();
+        m_vehiclePool = std::make_shared<WorkerPool>(threads);
+        std::cout << m_units.size() << " vehicles, per-vehicle work on " << m_vehiclePool->GetNumThreads()
+                  << " threads" << std::endl;
+    }
+    if (m_config.realtimeMode && !m_config.freeRun) {
+        m_pacer = std::make_shared<RealtimePacer>(m_config.realtimeSettings);
+    }
+
+    SetupScheduler();
+}
+
+void ChronoSimulation::SetupScheduler() {
+    // I/O consumers run on the I/O thread at their own rates, reading the latest state snapshot
+    m_ioReader = m_stateBus.Subscribe();
+    m_sensorPeriod = 1.0 / m_config.sensorRate;
+    m_posePeriod = GetPosePeriod();
+    if (m_units[0].sensors) {
+        m_sensorTask = m_ioScheduler.AddTask("sensors", m_sensorPeriod, 0.0, [this](double time) {
+            const StateFrame& frame = m_ioReader->Front();
+            for (size_t i = 0; i < m_units.size() && i < frame.vehicles.size(); i++) {
+                if (frame.unitIds[i] < 0) continue;
+                m_units[i].sensors->Update(time, frame.vehicles[i]);
+            }
+        });
+        if (m_config.freeRun) {
+            m_ioScheduler.AddTask("clock", 1.0 / m_config.clockRate, 0.0,
+                                  [this](double time) { m_units[0].sensors->PublishClock(time); });
+        }
+    }
+    // In lockstep the pose travels in the StepResponse; streaming would interleave on the socket
+    if (m_tcp_server && !m_config.lockstep) {
+        m_poseTask = m_ioScheduler.AddTask("pose", m_posePeriod, 0.0,
+                                           [this](double time) { PublishPose(m_ioReader->Front()); });
+    }
+
+    // Work that touches Chrono objects stays on the physics thread; with the async renderer
+    // that is only the hand-off of transforms, drawing happens on the render thread
+    if (m_renderer) {
+        m_renderTask = m_scheduler.AddTask("render", 1.0 / m_config.targetFps, 0.0,
+                                           [this](double time) { m_renderer->Submit(time); });
+    } else if (m_vis) {
+        m_renderTask = m_scheduler.AddTask("render", 1.0 / m_config.targetFps, 0.0, [this](double time) {
+            m_vis->BeginScene();
+            m_vis->Render();
+            m_vis->EndScene();
+        });
+    }
+    if (!m_config.trajectoryFile.empty()) {
+        // Logged on the physics thread so every run samples exactly the same sim times
+        m_trajectory = std::make_shared<TrajectoryLog>();
+        if (m_trajectory->Open(m_config.trajectoryFile)) {
+            m_scheduler.AddTask("trajectory", 1.0 / m_config.trajectoryRate, 0.0,
+                                [this](double time) { m_trajectory->Write(time, CaptureVehicleState(m_units[0])); });
+        }
+    }
+    if (m_config.telemetryPeriod > 0) {
+        m_scheduler.AddTask("telemetry", m_config.telemetryPeriod, m_config.telemetryPeriod,
+                            [this](double time) { LogTelemetry(time); });
+    }
 }
 
 void ChronoSimulation::SetupSensors() {
     // Create the physical sensors
-    m_sensors = std::make_shared<PhysicalSensors>(m_vehicle.get(), m_terrain_coords.get());
+    // In free-run mode sim time decouples from wall clock, so publish /clock for use_sim_time nodes
+    for (auto& unit : m_units) {
+        bool publish_clock = m_config.freeRun && unit.index == 0;
+        unit.sensors = std::make_shared<PhysicalSensors>(unit.vehicle.get(), m_terrain_coords.get(), publish_clock,
+                                                         unit.rosNamespace, m_config.rosPrefix + "/clock");
+    }
+}
+
+void ChronoSimulation::SetupDrivers() {
+    for (auto& unit : m_units) {
+        ChVehicle& vehicle = *unit.vehicle;
+        if (!m_config.replayInputsFile.empty() && !unit.active) {
+            // Traces do not contain spawns; pool vehicles stay idle during a replay
+            unit.externalDriver = std::make_shared<ExternalDriver>(vehicle);
+            unit.driver = unit.externalDriver;
+        } else if (!m_config.replayInputsFile.empty()) {
+            unit.replay = std::make_shared<ReplayDriver>(vehicle);
+            if (!unit.replay->Load(m_config.replayInputsFile, unit.unitId)) {
+                throw std::runtime_error("Cannot replay unit " + std::to_string(unit.unitId) + " from " +
+                                         m_config.replayInputsFile);
+            }
+            // Step sizes come from the trace
+            m_config.adaptiveStep = false;
+            unit.driver = unit.replay;
+        } else if (m_config.lockstep || m_config.externalInputs) {
+            unit.externalDriver = std::make_shared<ExternalDriver>(vehicle);
+            unit.driver = unit.externalDriver;
+        } else if (m_config.scriptedDriver || !m_config.useRos) {
+            unit.driver = std::make_shared<MyDriver>(vehicle, m_config.driverDelay);
+        } else {
+            unit.driver = std::make_shared<ROSDriver>(vehicle, 20, .95, unit.rosNamespace);
+        }
+        unit.driver->Initialize();
+    }
+
+    if (m_config.externalInputs) {
+        std::cout << "Driver inputs are set in-process" << std::endl;
+    } else if (m_config.lockstep) {
+        std::cout << "Lockstep mode: driver inputs come from StepRequest packets" << std::endl;
+    } else if (m_config.replayInputsFile.empty() && (m_config.scriptedDriver || !m_config.useRos)) {
+        std::cout << "Using scripted driver" << std::endl;
+    }
+}
+
+void ChronoSimulation::ForEachVehicle(const std::function<void(VehicleUnit&)>& fn, bool skip_primary) {
+    int begin = skip_primary ? 1 : 0;
+    if (m_vehiclePool) {
+        m_vehiclePool->ParallelFor(begin, (int)m_units.size(), [&](int i) {
+            if (m_units[i].active) fn(m_units[i]);
+        });
+    } else {
+        for (size_t i = begin; i < m_units.size(); i++) {
+            if (m_units[i].active) fn(m_units[i]);
+        }
+    }
+}
+
+void ChronoSimulation::UpdateVehicleLod(double step) {
+    const VehicleLod::Settings& settings = m_config.lodSettings;
+    ChVector3d primary = m_vehicle->GetChassisBody()->GetPos();
+    // The primary may be parked in another region; then distance alone demotes nobody
+    bool has_primary = m_units[0].active;
+
+    for (auto& unit : m_units) {
+        if (!unit.lod || !unit.active) continue;
+        unit.lod->UpdateIdle(step, unit.inputs);
+
+        ChVector3d pos = unit.vehicle->GetChassisBody()->GetPos();
+        double distance = (pos - primary).Length();
+
+        // Anything that could touch another full vehicle must be full itself
+        bool interacting = false;
+        for (const auto& other : m_units) {
+            if (&other == &unit || !other.active || other.IsReduced()) continue;
+            if ((other.vehicle->GetChassisBody()->GetPos() - pos).Length() < settings.interactionRadius) {
+                interacting = true;
+                break;
+            }
+        }
+
+        // Hysteresis between the promote and demote radii avoids flapping at the boundary
+        bool close = !has_primary ||
+                     (unit.IsReduced() ? distance < settings.promoteRadius : distance < settings.demoteRadius);
+        bool idle = settings.idleTime > 0 && unit.lod->GetIdleTime() >= settings.idleTime;
+        bool full = interacting || (close && !idle);
+
+        if (full && unit.IsReduced()) {
+            unit.lod->Promote();
+            std::cout << "LOD: vehicle " << unit.unitId << " -> full model at t=" << m_system->GetChTime()
+                      << " (distance " << distance << " m)" << std::endl;
+        } else if (!full && !unit.IsReduced()) {
+            unit.lod->Demote();
+            std::cout << "LOD: vehicle " << unit.unitId << " -> kinematic model at t=" << m_system->GetChTime()
+                      << " (distance " << distance << " m" << (idle ? ", idle" : "") << ")" << std::endl;
+        }
+    }
+}
+
+VehicleUnit* ChronoSimulation::FindUnit(int unit_id) {
+    for (auto& unit : m_units) {
+        if (unit.active && unit.unitId == unit_id) {
+            return &unit;
+        }
+    }
+    return nullptr;
 }
 
 void ChronoSimulation::SetupVehicle() {
+    // Spawn pool vehicles are built up front together with the initial ones and parked,
+    // so a spawn only has to move and release an existing vehicle. With regions, every
+    // process builds every slot but only starts the vehicles whose start is in its strip;
+    // the others stay parked until handed over.
+    if (m_config.systemBackend == SystemBackend::MULTICORE) {
+        CreateMulticoreSystem();
+    }
+
+    int total = m_config.numVehicles + m_config.spawnPoolSize;
+    int started = 0;
+    for (int i = 0; i < total; i++) {
+        ChVector3d ros_loc = m_config.initLoc + m_config.vehicleSpacing * i;
+        bool pooled = i >= m_config.numVehicles;
+        bool owned = !m_regions ||
+                     m_regions->RegionOf(m_terrain_coords->convertRosToChrono(ros_loc).x()) == m_regions->GetIndex();
+        bool parked = pooled || !owned;
+
+        VehicleUnit unit;
+        unit.index = i;
+        unit.unitId = parked ? -1 : m_config.firstUnitId + i;
+        unit.active = !parked;
+        unit.rosNamespace = m_config.rosPrefix + "/robot" + std::to_string(i);
+        started += parked ? 0 : 1;
+
+        // The first vehicle creates and owns the system, the others are added to it
+        ChSystem* system = m_vehicle ? m_vehicle->GetSystem() : m_backendSystem.get();
+        size_t first_body = system ? system->GetBodies().size() : 0;
+        size_t first_shaft = system ? system->GetShafts().size() : 0;
+        if (parked) {
+            ros_loc.z() -= kParkingDepth;
+        }
+        unit.vehicle = CreateVehicle(system, ros_loc);
+        if (i == 0) {
+            m_vehicle = unit.vehicle;
+        }
+
+        // Bodies and shafts are appended in creation order, so the new ones belong to this vehicle
+        const auto& bodies = m_vehicle->GetSystem()->GetBodies();
+        unit.bodies.assign(bodies.begin() + first_body, bodies.end());
+        const auto& shafts = m_vehicle->GetSystem()->GetShafts();
+        unit.shafts.assign(shafts.begin() + first_shaft, shafts.end());
+        if (parked) {
+            SetUnitActive(unit, false);
+        }
+        m_units.push_back(unit);
+    }
+    if (m_regions) {
+        std::cout << "Region " << m_regions->GetIndex() << ": " << started << " of " << m_config.numVehicles
+                  << " vehicles start in this strip" << std::endl;
+    }
+    if (m_config.spawnPoolSize > 0) {
+        std::cout << "Spawn pool: " << m_config.spawnPoolSize << " parked vehicles" << std::endl;
+    }
+}
+
+bool ChronoSimulation::IsBackendAvailable(SystemBackend backend) {
+#ifdef CHRONO_BACKEND_MULTICORE
+    return true;
+#else
+    return backend != SystemBackend::MULTICORE;
+#endif
+}
+
+const char* ChronoSimulation::GetBackendName(SystemBackend backend) {
+    return backend == SystemBackend::MULTICORE ? "multicore" : "nsc";
+}
+
+void ChronoSimulation::CreateMulticoreSystem() {
+#ifdef CHRONO_BACKEND_MULTICORE
+    // The vehicle would set up its own system with Z-up gravity; an external one needs it here
+    auto system = std::make_shared<ChSystemMulticoreNSC>();
+    system->SetGravitationalAcceleration(ChVector3d(0, 0, -9.81));
+
+    // Frictional contact with the Barzilai-Borwein solver, the closest match to the NSC setup
+    auto& settings = *system->GetSettings();
+    settings.solver.solver_mode = SolverMode::SLIDING;
+    settings.solver.max_iteration_normal = 0;
+    settings.solver.max_iteration_spinning = 0;
+    settings.solver.tolerance = 1e-3;
+    settings.solver.alpha = 0;
+    settings.solver.contact_recovery_speed = -1;
+    settings.solver.use_full_inertia_tensor = false;
+    settings.solver.compute_N = false;
+    settings.collision.collision_envelope = 0.01;
+    settings.collision.narrowphase_algorithm = ChNarrowphase::Algorithm::HYBRID;
+    settings.collision.bins_per_axis = ChVector3i(10, 10, 10);
+    system->ChangeSolverType(SolverType::BB);
+
+    m_backendSystem = system;
+    std::cout << "System backend: Chrono::Multicore" << std::endl;
+
+    // UpdateTimestep() reads the convergence of the NSC iterative solver, which Multicore does not use
+    if (m_config.adaptiveStep) {
+        std::cout << "Adaptive step is not available on Multicore; using a fixed step" << std::endl;
+        m_config.adaptiveStep = false;
+    }
+#else
+    throw std::runtime_error("Multicore backend requested, but this build has no Chrono::Multicore");
+#endif
+}
+
+void ChronoSimulation::SetSolverMaxIterations(int iterations) {
+#ifdef CHRONO_BACKEND_MULTICORE
+    if (auto multicore = std::dynamic_pointer_cast<ChSystemMulticore>(m_backendSystem)) {
+        multicore->GetSettings()->solver.max_iteration_sliding = iterations;
+        multicore->GetSettings()->solver.max_iteration_bilateral = iterations;
+        return;
+    }
+#endif
+    m_system->GetSolver()->AsIterative()->SetMaxIterations(iterations);
+}
+
+int ChronoSimulation::GetSolverMaxIterations() const {
+#ifdef CHRONO_BACKEND_MULTICORE
+    if (auto multicore = std::dynamic_pointer_cast<ChSystemMulticore>(m_backendSystem)) {
+        return (int)multicore->GetSettings()->solver.max_iteration_sliding;
+    }
+#endif
+    return m_system->GetSolver()->AsIterative()->GetMaxIterations();
+}
+
+void ChronoSimulation::SetUnitActive(VehicleUnit& unit, bool active) {
+    // A reduced vehicle is released first so the LOD state starts clean
+    if (unit.IsReduced()) {
+        unit.lod->Promote();
+    }
+    for (auto& body : unit.bodies) {
+        body->SetFixed(!active);
+        body->SetPosDt(VNULL);
+        body->SetAngVelParent(VNULL);
+    }
+    for (auto& shaft : unit.shafts) {
+        shaft->SetPosDt(0);
+    }
+    unit.active = active;
+}
+
+std::shared_ptr<Generic_Vehicle> ChronoSimulation::CreateVehicle(ChSystem* system, const ChVector3d& ros_loc) {
     // Determine initial location based on patch type
-    ChVector3d init_loc = m_terrain_coords->convertRosToChrono(m_config.initLoc); // ChVector3d(100,0,5); //
+    ChVector3d init_loc = m_terrain_coords->convertRosToChrono(ros_loc); // ChVector3d(100,0,5); //
     
     // Create the vehicle
-    m_vehicle = std::make_shared<Generic_Vehicle>(
-        false, 
-        SuspensionTypeWV::DOUBLE_WISHBONE, 
-        SuspensionTypeWV::DOUBLE_WISHBONE,
-        SteeringTypeWV::PITMAN_ARM, 
-        DrivelineTypeWV::AWD, 
-        BrakeType::SHAFTS, 
-        false, 
-        false
-    );
+    std::shared_ptr<Generic_Vehicle> vehicle;
+    if (system) {
+        vehicle = std::make_shared<Generic_Vehicle>(
+            system,
+            false, 
+            SuspensionTypeWV::DOUBLE_WISHBONE, 
+            SuspensionTypeWV::DOUBLE_WISHBONE,
+            SteeringTypeWV::PITMAN_ARM, 
+            DrivelineTypeWV::AWD, 
+            BrakeType::SHAFTS, 
+            false, 
+            false
+        );
+    } else {
+        vehicle = std::make_shared<Generic_Vehicle>(
+            false, 
+            SuspensionTypeWV::DOUBLE_WISHBONE, 
+            SuspensionTypeWV::DOUBLE_WISHBONE,
+            SteeringTypeWV::PITMAN_ARM, 
+            DrivelineTypeWV::AWD, 
+            BrakeType::SHAFTS, 
+            false, 
+            false
+        );
+    }
     
-    m_vehicle->Initialize(ChCoordsys<>(init_loc, m_config.initRot));
-    m_vehicle->SetChassisVisualizationType(VisualizationType::PRIMITIVES);
-    m_vehicle->SetSuspensionVisualizationType(VisualizationType::PRIMITIVES);
-    m_vehicle->SetSteeringVisualizationType(VisualizationType::PRIMITIVES);
-    m_vehicle->SetWheelVisualizationType(VisualizationType::PRIMITIVES);
-    m_vehicle->SetCollisionSystemType(ChCollisionSystem::Type::BULLET);
+    vehicle->Initialize(ChCoordsys<>(init_loc, m_config.initRot));
+    vehicle->SetChassisVisualizationType(VisualizationType::PRIMITIVES);
+    vehicle->SetSuspensionVisualizationType(VisualizationType::PRIMITIVES);
+    vehicle->SetSteeringVisualizationType(VisualizationType::PRIMITIVES);
+    vehicle->SetWheelVisualizationType(VisualizationType::PRIMITIVES);
+    if (!system) {
+        vehicle->SetCollisionSystemType(ChCollisionSystem::Type::BULLET);
+    }
     
     // Initialize powertrain
     auto engine_type = EngineModelType::SHAFTS;
     auto transmission_type = TransmissionModelType::AUTOMATIC_SHAFTS;
-    m_vehicle->CreateAndInitializePowertrain(engine_type, transmission_type);
+    vehicle->CreateAndInitializePowertrain(engine_type, transmission_type);
     
     // Setup tires
     bool use_mesh = m_config.useTerrainMesh;
@@ -140,70 +599,25 @@ void ChronoSimulation::SetupVehicle() {
     auto tire_RL = chrono_types::make_shared<HMMWV_RigidTire>("RL", use_mesh);
     auto tire_RR = chrono_types::make_shared<HMMWV_RigidTire>("RR", use_mesh);
 
-    m_vehicle->InitializeTire(tire_FL, m_vehicle->GetAxle(0)->m_wheels[LEFT], VisualizationType::NONE);
-    m_vehicle->InitializeTire(tire_FR, m_vehicle->GetAxle(0)->m_wheels[RIGHT], VisualizationType::NONE);
-    m_vehicle->InitializeTire(tire_RL, m_vehicle->GetAxle(1)->m_wheels[LEFT], VisualizationType::NONE);
-    m_vehicle->InitializeTire(tire_RR, m_vehicle->GetAxle(1)->m_wheels[RIGHT], VisualizationType::NONE);
+    vehicle->InitializeTire(tire_FL, vehicle->GetAxle(0)->m_wheels[LEFT], VisualizationType::NONE);
+    vehicle->InitializeTire(tire_FR, vehicle->GetAxle(0)->m_wheels[RIGHT], VisualizationType::NONE);
+    vehicle->InitializeTire(tire_RL, vehicle->GetAxle(1)->m_wheels[LEFT], VisualizationType::NONE);
+    vehicle->InitializeTire(tire_RR, vehicle->GetAxle(1)->m_wheels[RIGHT], VisualizationType::NONE);
+    return vehicle;
 }
 
 void ChronoSimulation::GetScale() {
-    double scale = m_config.terrainZ;
-    double actual_height = 0.0;
-    double tolerance = 0.01; // 1 cm tolerance
-    int max_iterations = 1;
-    int iteration = 0;
-
-    double min_z = 0.0;
-    double max_z = 0.0;
-    std::shared_ptr<SCMTerrain> TmpTerrain = std::make_shared<SCMTerrain>(m_vehicle->GetSystem());
-    TmpTerrain->SetSoilParameters(
-        m_config.soilKphi,
-        m_config.soilKc,
-        m_config.soilN,
-        m_config.soilCohesion,
-        m_config.soilFriction,
-        m_config.soilJanosi,
-        m_config.soilStiffness,
-        m_config.soilDamping
-    );
+    // The measurement needs a full throwaway SCM mesh, so it is shared by all simulations
+    // in the process that use the same heightmap. The heightmap itself is still loaded by
+    // each SCMTerrain in SetupTerrain()
+    TerrainSource::Shape shape{m_config.heightmapFile, m_config.terrainHeight, m_config.terrainWidth,
+                               m_config.terrainZ, m_config.terrainDelta};
+    auto source = TerrainSource::Get(shape);
 
-    TmpTerrain->Initialize(
-        m_config.heightmapFile, 
-        m_config.terrainHeight, 
-        m_config.terrainWidth, 
-        0, 
-        m_config.terrainZ, 
-        m_config.terrainDelta
-    );
-    
-    auto meshHolder = TmpTerrain->GetMesh();
-    auto mesh = meshHolder->GetMesh();
-    const auto &vertices = mesh->GetCoordsVertices();
-
-    min_z = std::numeric_limits<double>::max();
-   /* m_terrain_coords = std::make_shared<TerrainSystemCoordinates>(
-        m_config.terrainHeight,
-        m_config.terrainWidth, 
-        m_config.unrealZOfsset+min_z,
-        m_config.corner);*/
-    max_z = std::numeric_limits<double>::lowest();
-
-    for (const auto &v : vertices)
-    {
-        if (v.z() < min_z)
-            min_z = v.z();
-        if (v.z() > max_z)
-            max_z = v.z();
-    }
-
-    z_min_offset = min_z;
-    m_terrain_coords->update(m_config.terrainHeight, m_config.terrainWidth, m_config.unrealZOfsset + min_z, m_config.corner);
-    actual_height = max_z - min_z;
-
-
-    double scaling_factor = m_config.terrainZ / actual_height;
-    scale *= scaling_factor;
-    z_scale = scale;
+    z_min_offset = source->GetMinZ();
+    z_scale = source->GetScale();
+    m_terrain_coords->update(m_config.terrainHeight, m_config.terrainWidth, m_config.unrealZOfsset + z_min_offset,
+                             m_config.corner);
     std::cout << "Z Scale: " << z_scale << std::endl;
     std::cout << "minz: " << z_min_offset << std::endl;
 }
@@ -211,7 +625,8 @@ void ChronoSimulation::GetScale() {
 void ChronoSimulation::SetupTerrain() {
     // Create terrain
     GetScale();
-    m_terrain = std::make_shared<SCMTerrain>(m_vehicle->GetSystem());
+    ChSystem* terrain_system = m_coupling ? m_coupling->GetSystem() : m_vehicle->GetSystem();
+    m_terrain = std::make_shared<SCMTerrain>(terrain_system);
     
     // Set soil parameters
     m_terrain->SetSoilParameters(
@@ -226,7 +641,13 @@ void ChronoSimulation::SetupTerrain() {
     );
     
     // Add moving patch and initialize
-    m_terrain->AddMovingPatch(m_vehicle->GetChassisBody(), ChVector3d(0, 0, 0), ChVector3d(5, 3, 1));
+    if (m_coupling) {
+        m_coupling->AttachTerrain(m_terrain);
+    } else {
+        for (auto& unit : m_units) {
+            m_terrain->AddMovingPatch(unit.vehicle->GetChassisBody(), ChVector3d(0, 0, 0), ChVector3d(5, 3, 1));
+        }
+    }
 
     double scale = m_config.terrainZ;
     double actual_height = 0.0;
@@ -261,155 +682,915 @@ void ChronoSimulation::SetupVisualization() {
 
 
 void ChronoSimulation::Run() {
-    double render_step_size = 1.0 / m_config.targetFps;
-    double last_render_time = 0.0;
+    // Run() executes on the physics thread, so realtime scheduling is applied here
+    if (m_pacer) {
+        m_pacer->ConfigureCurrentThread();
+    }
+
+    // The client is accepted here rather than in Initialize(), so a prepared simulation
+    // can wait in a warm pool without a connection
+    if (m_tcp_server && !WaitForClient()) {
+        return;
+    }
+
+    // Lockstep clients can always return to the initial state through slot 0
+    if (m_config.lockstep) {
+        m_snapshots[0] = SaveSnapshot();
+    }
+
+    StartIo();
+    if (m_renderer) {
+        m_renderer->Start();
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_snapshotRequestMutex);
+        m_serveSnapshotRequests = true;
+    }
+
+    try {
+        ChRealtimeStepTimer realtime_timer;
+        bool running = true;
+        while (running) {
+            auto cycle_start = std::chrono::steady_clock::now();
+
+            // Visualization: use m_vis->Run(); Headless: run until externally stopped (or add your own break)
+            if (m_vis) {
+                running = m_vis->Run();
+            } else if (m_renderer) {
+                running = m_renderer->IsRunning();
+            }
+            if (m_stopRequested) {
+                running = false;
+            }
+
+            // Physics substeps for this I/O cycle
+            double cycle_start_time = m_system->GetChTime();
+            if (m_config.lockstep) {
+                if (!RunLockstepRequest()) {
+                    running = false;
+                }
+            } else {
+                if (m_tcp_server && m_clientConnected) {
+                    m_clientConnected = HandleClientPackets();
+                }
+                if (m_regions) {
+                    ExchangeRegionState();
+                }
+                for (int i = 0; i < m_config.physicsSubsteps; i++) {
+                    StepPhysics(m_stepSize);
+                    UpdateTimestep();
+                }
+            }
+
+            if (m_snapshotRequested) {
+                ServeSnapshotRequests();
+            }
+
+            // Run render and telemetry that are due; I/O tasks follow the state bus on their own thread
+            double time = m_system->GetChTime();
+            m_scheduler.Run(time);
+
+            if (m_config.duration > 0 && time >= m_config.duration) {
+                running = false;
+            }
+            if (m_units[0].replay && m_units[0].replay->Finished(time)) {
+                std::cout << "Input trace finished at t=" << time << std::endl;
+                running = false;
+            }
+
+            double cycle_time = time - cycle_start_time;
+            if (m_qos) {
+                double cycle_wall_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - cycle_start).count();
+                if (m_qos->Update(time, cycle_wall_time, cycle_time)) {
+                    ApplyQosLevels();
+                }
+            }
 
-    ChRealtimeStepTimer realtime_timer;
-    bool running = true;
-    while (running) {
-        // Visualization: use m_vis->Run(); Headless: run until externally stopped (or add your own break)
-        if (m_config.useVisualization) {
-            running = m_vis->Run();
+            // Pace to wall clock unless free-running; in lockstep the client sets the pace
+            if (m_pacer && !m_config.lockstep) {
+                m_pacer->Spin(cycle_time);
+            } else if (!m_config.freeRun && !m_config.lockstep) {
+                realtime_timer.Spin(cycle_time);
+            }
         }
+    } catch (...) {
+        // A failed step (e.g. the watchdog out of checkpoints) ends the run; the caller gets the error
+        EndRun();
+        throw;
+    }
+    EndRun();
+}
 
-        double time = m_system->GetChTime();
+void ChronoSimulation::EndRun() {
+    StopIo();
+    if (m_renderer) {
+        m_renderer->Stop();
+    }
+    {
+        // Nobody will take snapshots any more
+        std::lock_guard<std::mutex> lock(m_snapshotRequestMutex);
+        m_serveSnapshotRequests = false;
+        for (auto& request : m_snapshotRequests) {
+            request.set_value(nullptr);
+        }
+        m_snapshotRequests.clear();
+        m_snapshotRequested = false;
+    }
+    if (m_recorder) {
+        m_recorder->Close();
+    }
 
-        // Get driver inputs
-        DriverInputs driver_inputs = m_driver->GetInputs();
+    if (m_pacer) {
+        m_pacer->PrintReport(std::cout);
+    }
+}
 
-        // Update all modules
-        m_driver->Synchronize(time);
-        m_terrain->Synchronize(time);
-        m_vehicle->Synchronize(time, driver_inputs, *m_terrain);
+void ChronoSimulation::SetInputs(int vehicle, double throttle, double steering, double braking) {
+    m_units[vehicle].externalDriver->SetInputs(throttle, steering, braking);
+}
 
-        // Render the scene at the specified FPS
-        if (m_config.useVisualization && time - last_render_time >= render_step_size) {
-            m_vis->BeginScene();
-            m_vis->Render();
-            m_vis->EndScene();
-            last_render_time = time;
+void ChronoSimulation::Advance(int steps) {
+    // Fixed step like lockstep, so the same input sequence always gives the same trajectory
+    for (int i = 0; i < steps; i++) {
+        StepPhysics(m_stepSize);
+    }
+}
+
+std::shared_ptr<const SimulationSnapshot> ChronoSimulation::RequestSnapshot() {
+    std::future<std::shared_ptr<const SimulationSnapshot>> future;
+    {
+        std::lock_guard<std::mutex> lock(m_snapshotRequestMutex);
+        if (!m_serveSnapshotRequests) {
+            return nullptr;
+        }
+        m_snapshotRequests.emplace_back();
+        future = m_snapshotRequests.back().get_future();
+        m_snapshotRequested = true;
+    }
+    return future.get();
+}
+
+void ChronoSimulation::ServeSnapshotRequests() {
+    // One snapshot serves every request of this cycle
+    std::shared_ptr<const SimulationSnapshot> snapshot = SaveSnapshot();
+    std::lock_guard<std::mutex> lock(m_snapshotRequestMutex);
+    for (auto& request : m_snapshotRequests) {
+        request.set_value(snapshot);
+    }
+    m_snapshotRequests.clear();
+    m_snapshotRequested = false;
+}
+
+bool ChronoSimulation::WaitForClient() {
+    std::cout << "Waiting for TCP client on port " << m_config.tcpPort << std::endl;
+    while (!m_tcp_server->acceptClient(100)) {
+        if (m_stopRequested) {
+            return false;
         }
+    }
+    std::cout << "TCP client connected on port " << m_config.tcpPort << std::endl;
+    return true;
+}
 
-        // Advance simulation
-        m_driver->Advance(m_config.stepSize);
-        m_terrain->Advance(m_config.stepSize);
-        m_vehicle->Advance(m_config.stepSize);
-        if (m_config.useVisualization) {
-            m_vis->Advance(m_config.stepSize);
+bool ChronoSimulation::RunLockstepRequest() {
+    SendablePacket_t header;
+    std::vector<uint8_t> payload;
+    TcpPositionServer::ReceiveStatus status;
+    // Wake up now and then so Stop() is noticed while the client is idle
+    while ((status = m_tcp_server->receivePacket(header, payload, 100)) == TcpPositionServer::ReceiveStatus::Empty) {
+        if (m_stopRequested) {
+            return false;
         }
-        m_sensors->Update(time);
-        ChVector3d vehicle_pos = m_vehicle->GetChassisBody()->GetPos();
-        ChQuaternion<> vehicle_rot = m_vehicle->GetChassisBody()->GetRot();
-        m_tcp_server.updatePositionOfUnit(123, vehicle_pos, vehicle_rot, *m_terrain_coords);
+    }
+    if (status == TcpPositionServer::ReceiveStatus::Disconnected) {
+        return false;
+    }
+
+    switch (header.type) {
+        case PacketTypes_t::StepRequestPacket: {
+            if (payload.size() < sizeof(StepRequestSendable_t)) {
+                std::cerr << "Short step request (" << payload.size() << " bytes)" << std::endl;
+                break;
+            }
+            StepRequestSendable_t request;
+            memcpy(&request, payload.data(), sizeof(request));
 
-        realtime_timer.Spin(m_config.stepSize);
+            // Inputs are held for the whole request; the step size stays fixed so that
+            // the same request sequence always reproduces the same trajectory.
+            // The header id selects the vehicle; other vehicles keep their last inputs.
+            VehicleUnit* unit = FindUnit(header.id);
+            if (!unit) {
+                unit = &m_units[0];
+            }
+            unit->externalDriver->SetInputs(request.throttle, request.steering, request.braking);
+            uint32_t steps = std::max<uint32_t>(request.steps, 1);
+            for (uint32_t i = 0; i < steps; i++) {
+                StepPhysics(m_stepSize);
+            }
+            break;
+        }
+        case PacketTypes_t::SaveSnapshotPacket:
+            m_snapshots[header.id] = SaveSnapshot();
+            break;
+        case PacketTypes_t::CreateUnitPacket: {
+            if (payload.size() < sizeof(CreateUnitSendable_t)) {
+                std::cerr << "Short create unit request (" << payload.size() << " bytes)" << std::endl;
+                break;
+            }
+            CreateUnitSendable_t request;
+            memcpy(&request, payload.data(), sizeof(request));
+            SpawnUnit(header.id, request);
+            break;
+        }
+        case PacketTypes_t::DeleteUnitPacket:
+            DespawnUnit(header.id);
+            break;
+        case PacketTypes_t::RestoreSnapshotPacket: {
+            auto it = m_snapshots.find(header.id);
+            if (it != m_snapshots.end()) {
+                RestoreSnapshot(*it->second);
+            } else {
+                std::cerr << "No snapshot in slot " << header.id << std::endl;
+            }
+            break;
+        }
+        default:
+            std::cerr << "Ignoring packet of type " << static_cast<int>(header.type)
+                      << " while in lockstep mode" << std::endl;
+            break;
     }
+
+    // Every packet is answered, or the client would wait forever. Snapshot slots are not unit
+    // ids; those replies carry the primary vehicle, as do replies to a failed spawn, to a
+    // despawn and to malformed or unknown packets
+    bool unit_reply = header.type == PacketTypes_t::StepRequestPacket || header.type == PacketTypes_t::CreateUnitPacket;
+    VehicleUnit* unit = unit_reply ? FindUnit(header.id) : nullptr;
+    return SendLockstepResponse(unit ? *unit : m_units[0], header.seq);
 }
 
-// Add this helper function at the top level, before main()
-void printUsage() {
-    std::cout << "Usage: ./main [options]\n"
-              << "Options:\n"
-              << "  --pos x y z    : Set initial position (default: 277.39 -31.1 5.0)\n"
-              << "  --rot x y z    : Set initial rotation in degrees (default: 0 0 0)\n"
-              << "  --z-offset val : Set unreal Z offset (default: 2.3)\n"
-              << "  --no-viz       : Run without visualization\n";
+bool ChronoSimulation::HandleClientPackets() {
+    // Free-running: drain whatever the client sent since the last cycle without blocking
+    SendablePacket_t header;
+    std::vector<uint8_t> payload;
+    TcpPositionServer::ReceiveStatus status;
+    while ((status = m_tcp_server->pollPacket(header, payload)) == TcpPositionServer::ReceiveStatus::Packet) {
+        switch (header.type) {
+            case PacketTypes_t::CreateUnitPacket: {
+                if (payload.size() < sizeof(CreateUnitSendable_t)) {
+                    std::cerr << "Short create unit request (" << payload.size() << " bytes)" << std::endl;
+                    break;
+                }
+                CreateUnitSendable_t request;
+                memcpy(&request, payload.data(), sizeof(request));
+                SpawnUnit(header.id, request);
+                break;
+            }
+            case PacketTypes_t::DeleteUnitPacket:
+                DespawnUnit(header.id);
+                break;
+            default:
+                std::cerr << "Ignoring packet of type " << static_cast<int>(header.type) << std::endl;
+                break;
+        }
+    }
+    return status != TcpPositionServer::ReceiveStatus::Disconnected;
 }
 
-// Add this helper function to convert degrees to radians
-double degToRad(double deg) {
-    return deg * CH_PI / 180.0;
+VehicleUnit* ChronoSimulation::FindParkedUnit() {
+    for (auto& unit : m_units) {
+        if (unit.active) continue;
+        // Regions split the spawn pool, and parked fleet slots wait for their own vehicle to be handed over
+        if (m_regions) {
+            int slot = unit.index - m_config.numVehicles;
+            if (slot < 0 || slot % m_config.regionSettings.regions != m_regions->GetIndex()) continue;
+        }
+        return &unit;
+    }
+    return nullptr;
 }
 
-// Add this helper function to convert Euler angles to quaternion
-ChQuaternion<> eulerToQuaternion(double roll, double pitch, double yaw) {
-    // Convert degrees to radians
-    roll = degToRad(roll);
-    pitch = degToRad(pitch);
-    yaw = degToRad(yaw);
-    
-    // Create quaternion and set it using sequential rotations
-    ChQuaternion<> q(1, 0, 0, 0);
-    ChQuaternion<> qZ;
-    ChQuaternion<> qY;
-    ChQuaternion<> qX;
-    
-    qZ.SetFromAngleZ(yaw);
-    qY.SetFromAngleY(pitch);
-    qX.SetFromAngleX(roll);
-    
-    // Combine rotations: first roll (X), then pitch (Y), then yaw (Z)
-    q = qZ * qY * qX;
-    return q;
+bool ChronoSimulation::SpawnUnit(int unit_id, const CreateUnitSendable_t& request) {
+    if (unit_id < 0) {
+        std::cerr << "Spawn: invalid unit id " << unit_id << std::endl;
+        return false;
+    }
+    if (FindUnit(unit_id)) {
+        std::cerr << "Spawn: unit " << unit_id << " already exists" << std::endl;
+        return false;
+    }
+    VehicleUnit* unit = FindParkedUnit();
+    if (!unit) {
+        std::cerr << "Spawn: pool exhausted, unit " << unit_id << " not created (--spawn-pool)" << std::endl;
+        return false;
+    }
+
+    // Requested pose comes in Unreal coordinates; the chassis is dropped from just above the terrain
+    const TwistSendable_t& twist = request.twist;
+    ChVector3d pos = m_terrain_coords->convertUEToChrono(ChVector3d(twist.x, twist.y, twist.z));
+    ChVector3d rpy = m_terrain_coords->convertUEToChronoRotation(ChVector3d(twist.roll, twist.pitch, twist.yaw));
+    ChQuaternion<> rot = QuatFromAngleZ(rpy.z()) * QuatFromAngleY(rpy.y()) * QuatFromAngleX(rpy.x());
+    pos.z() = std::max(pos.z(), m_terrain->GetHeight(pos) + m_config.spawnClearance);
+
+    auto chassis = unit->vehicle->GetChassisBody();
+    VehicleLod::MoveBodies(unit->bodies, chassis->GetPos(), chassis->GetRot(), pos, rot);
+    SetUnitActive(*unit, true);
+    unit->unitId = unit_id;
+    unit->driver->SetThrottle(0);
+    unit->driver->SetSteering(0);
+    unit->driver->SetBraking(0);
+
+    std::cout << "Spawned unit " << unit_id << " (vehicle " << unit->index << ") at " << pos
+              << " t=" << m_system->GetChTime() << std::endl;
+    return true;
 }
 
-int main(int argc, char* argv[]) {
-    ChronoSimulation::Config config;
-    
-    // Parse command line arguments
-    for (int i = 1; i < argc; i++) {
-        std::string arg = argv[i];
-        
-        if (arg == "--pos" && i + 3 < argc) {
-            try {
-                double x = std::stod(argv[i + 1]);
-                double y = std::stod(argv[i + 2]);
-                double z = std::stod(argv[i + 3]);
-                config.initLoc = ChVector3d(x, y, z);
-                i += 3;
-            } catch (const std::exception& e) {
-                std::cerr << "Error parsing position arguments\n";
-                printUsage();
-                return 1;
+bool ChronoSimulation::DespawnUnit(int unit_id) {
+    VehicleUnit* unit = FindUnit(unit_id);
+    if (!unit) {
+        std::cerr << "Despawn: no unit " << unit_id << std::endl;
+        return false;
+    }
+    // The primary vehicle owns the system and cannot be removed
+    if (unit->index == 0) {
+        std::cerr << "Despawn: unit " << unit_id << " is the primary vehicle" << std::endl;
+        return false;
+    }
+
+    ParkUnit(*unit);
+    std::cout << "Despawned unit " << unit_id << " (vehicle " << unit->index << ") at t=" << m_system->GetChTime()
+              << std::endl;
+    return true;
+}
+
+void ChronoSimulation::ParkUnit(VehicleUnit& unit) {
+    // Back to the slot's parking spot, where SetupVehicle() builds parked vehicles
+    SetUnitActive(unit, false);
+    auto chassis = unit.vehicle->GetChassisBody();
+    ChVector3d park = m_config.initLoc + m_config.vehicleSpacing * unit.index;
+    park.z() -= kParkingDepth;
+    park = m_terrain_coords->convertRosToChrono(park);
+    VehicleLod::MoveBodies(unit.bodies, chassis->GetPos(), chassis->GetRot(), park, QUNIT);
+    unit.unitId = -1;
+}
+
+bool ChronoSimulation::AdoptUnit(const RegionExchange::Message& handoff) {
+    // The vehicle moves into the same slot here, whose driver listens on the same /robot<slot>
+    // topic, so ROS control follows it across the border
+    if (handoff.vehicle < 0 || handoff.vehicle >= (int)m_units.size()) {
+        std::cerr << "Handoff: unit " << handoff.unitId << " is in slot " << handoff.vehicle << ", this region has "
+                  << m_units.size() << " (same --vehicles and --spawn-pool in every region)" << std::endl;
+        return false;
+    }
+    VehicleUnit* unit = &m_units[handoff.vehicle];
+    if (unit->active) {
+        std::cerr << "Handoff: slot " << handoff.vehicle << " of unit " << handoff.unitId << " is busy as unit "
+                  << unit->unitId << ", it stays in region " << handoff.region << std::endl;
+        return false;
+    }
+    if (unit->bodies.size() != handoff.bodies.size()) {
+        std::cerr << "Handoff: unit " << handoff.unitId << " has " << handoff.bodies.size() << " bodies, expected "
+                  << unit->bodies.size() << std::endl;
+        return false;
+    }
+    if (unit->shafts.size() != handoff.shafts.size()) {
+        std::cerr << "Handoff: unit " << handoff.unitId << " has " << handoff.shafts.size() << " shafts, expected "
+                  << unit->shafts.size() << std::endl;
+        return false;
+    }
+
+    // Same vehicle model on both sides, so bodies and shafts match by creation order. Activating
+    // first clears the parked velocities, then every body and shaft takes over the sender's state
+    // and the transmission its gear, so engine and driveline carry on at the sender's speed.
+    SetUnitActive(*unit, true);
+    for (size_t i = 0; i < unit->bodies.size(); i++) {
+        const RegionExchange::BodyState& state = handoff.bodies[i];
+        unit->bodies[i]->SetPos(state.pos);
+        unit->bodies[i]->SetRot(state.rot);
+        unit->bodies[i]->SetPosDt(state.vel);
+        unit->bodies[i]->SetAngVelParent(state.angVel);
+    }
+    for (size_t i = 0; i < unit->shafts.size(); i++) {
+        unit->shafts[i]->SetPos(handoff.shafts[i].pos);
+        unit->shafts[i]->SetPosDt(handoff.shafts[i].speed);
+    }
+    if (auto transmission = unit->vehicle->GetTransmission()) {
+        transmission->SetGear(handoff.gear);
+    }
+    // Seeded for drivers that hold inputs; a ROS driver continues from the latest cmd_vel
+    unit->unitId = handoff.unitId;
+    unit->driver->SetThrottle(handoff.throttle);
+    unit->driver->SetSteering(handoff.steering);
+    unit->driver->SetBraking(handoff.braking);
+    m_ghosts.erase(handoff.unitId);
+
+    std::cout << "Handoff: took unit " << handoff.unitId << " (vehicle " << unit->index << ") from region "
+              << handoff.region << " at t=" << m_system->GetChTime() << std::endl;
+    return true;
+}
+
+void ChronoSimulation::ExchangeRegionState() {
+    const double kHandoffRetry = 0.2;  // Sim time before an unanswered handoff is sent again (s)
+    const double kGhostTimeout = 0.5;  // Sim time a ghost is shown without updates (s)
+    double time = m_system->GetChTime();
+
+    for (const auto& message : m_regions->Receive()) {
+        switch (message.type) {
+            case RegionExchange::MessageType::Ghost: {
+                if (message.bodies.empty() || FindUnit(message.unitId)) break;
+                const RegionExchange::BodyState& chassis = message.bodies[0];
+                Ghost& ghost = m_ghosts[message.unitId];
+                ghost.state.pos = chassis.pos;
+                ghost.state.rot = chassis.rot;
+                ghost.state.vel = chassis.vel;
+                ghost.state.acc = VNULL;
+                ghost.state.rotDt = ChQuaternion<>(0, chassis.angVel * 0.5) * chassis.rot;
+                ghost.received = time;
+                break;
+            }
+            case RegionExchange::MessageType::Handoff: {
+                // A repeated request for a unit already taken over only needs the answer again
+                bool accepted = FindUnit(message.unitId) || AdoptUnit(message);
+                RegionExchange::Message reply;
+                reply.type = accepted ? RegionExchange::MessageType::Accept : RegionExchange::MessageType::Reject;
+                reply.unitId = message.unitId;
+                reply.time = time;
+                m_regions->Send(message.region, reply);
+                break;
+            }
+            case RegionExchange::MessageType::Accept:
+                if (m_handoffs.erase(message.unitId) && FindUnit(message.unitId)) {
+                    std::cout << "Handoff: gave unit " << message.unitId << " to region " << message.region
+                              << " at t=" << time << std::endl;
+                    ParkUnit(*FindUnit(message.unitId));
+                }
+                break;
+            case RegionExchange::MessageType::Reject:
+                // Kept here and simulated outside the strip; the next retry may find a free vehicle
+                break;
+        }
+    }
+
+    for (auto it = m_ghosts.begin(); it != m_ghosts.end();) {
+        it = time - it->second.received > kGhostTimeout ? m_ghosts.erase(it) : std::next(it);
+    }
+
+    for (auto& unit : m_units) {
+        if (!unit.active) continue;
+        auto chassis = unit.vehicle->GetChassisBody();
+        double x = chassis->GetPos().x();
+
+        std::vector<int> ghost_targets = m_regions->GhostTargets(x);
+        if (!ghost_targets.empty()) {
+            RegionExchange::Message ghost;
+            ghost.type = RegionExchange::MessageType::Ghost;
+            ghost.unitId = unit.unitId;
+            ghost.time = time;
+            ghost.bodies.push_back({chassis->GetPos(), chassis->GetRot(), chassis->GetPosDt(), chassis->GetAngVelParent()});
+            for (int region : ghost_targets) {
+                m_regions->Send(region, ghost);
+            }
+        }
+
+        // The primary vehicle is handed over like any other; parking it leaves the system it owns in place
+        int target = m_regions->HandoffTarget(x);
+        if (target < 0) continue;
+        auto pending = m_handoffs.find(unit.unitId);
+        if (pending != m_handoffs.end() && time - pending->second < kHandoffRetry) continue;
+
+        RegionExchange::Message handoff;
+        handoff.type = RegionExchange::MessageType::Handoff;
+        handoff.unitId = unit.unitId;
+        handoff.vehicle = unit.index;
+        handoff.time = time;
+        handoff.throttle = unit.inputs.m_throttle;
+        handoff.steering = unit.inputs.m_steering;
+        handoff.braking = unit.inputs.m_braking;
+        for (auto& body : unit.bodies) {
+            handoff.bodies.push_back({body->GetPos(), body->GetRot(), body->GetPosDt(), body->GetAngVelParent()});
+        }
+        for (auto& shaft : unit.shafts) {
+            handoff.shafts.push_back({shaft->GetPos(), shaft->GetPosDt()});
+        }
+        if (auto transmission = unit.vehicle->GetTransmission()) {
+            handoff.gear = transmission->GetCurrentGear();
+        }
+        m_regions->Send(target, handoff);
+        m_handoffs[unit.unitId] = time;
+    }
+}
+
+bool ChronoSimulation::SendLockstepResponse(const VehicleUnit& unit, uint32_t seq) {
+    VehicleState state = CaptureVehicleState(unit);
+    return m_tcp_server->sendStepResponse(unit.unitId, seq, m_stepCount, m_system->GetChTime(), state.pos, state.rot,
+                                          unit.vehicle->GetSpeed(), *m_terrain_coords);
+}
+
+std::shared_ptr<SimulationSnapshot> ChronoSimulation::SaveSnapshot() {
+    auto snapshot = std::make_shared<SimulationSnapshot>();
+    snapshot->vehicle.Capture(*m_system);
+    if (m_coupling) {
+        snapshot->coupling.Capture(*m_coupling->GetSystem());
+        snapshot->couplingForces = m_coupling->GetForces();
+    }
+    snapshot->terrainNodes = m_terrain->GetModifiedNodes(true);
+    for (const auto& unit : m_units) {
+        snapshot->driverInputs.push_back(unit.driver->GetInputs());
+        snapshot->unitIds.push_back(unit.unitId);
+    }
+    snapshot->stepCount = m_stepCount;
+    snapshot->stepSize = m_stepSize;
+    return snapshot;
+}
+
+void ChronoSimulation::RestoreSnapshot(const SimulationSnapshot& snapshot) {
+    // The snapshot has no terrain to give a remote node, and restored vehicles on an
+    // unrestored terrain would be a different state
+    if (m_coupling && m_coupling->IsRemote()) {
+        throw std::runtime_error("Cannot restore a snapshot with the terrain in a terrain node");
+    }
+    auto start = std::chrono::steady_clock::now();
+
+    // Units spawned or despawned since the snapshot go back to their saved pool state
+    // before the system state is written, which restores their poses as well
+    for (size_t i = 0; i < m_units.size() && i < snapshot.unitIds.size(); i++) {
+        bool active = snapshot.unitIds[i] >= 0;
+        if (m_units[i].active != active) {
+            SetUnitActive(m_units[i], active);
+        }
+        m_units[i].unitId = snapshot.unitIds[i];
+    }
+
+    snapshot.vehicle.Restore(*m_system);
+    if (m_coupling) {
+        snapshot.coupling.Restore(*m_coupling->GetSystem());
+        m_coupling->SetForces(snapshot.couplingForces);
+    }
+
+    // Terrain: snapshot nodes get their saved level, nodes deformed since then go back
+    // to the undeformed surface
+    std::set<std::pair<int, int>> saved;
+    for (const auto& node : snapshot.terrainNodes) {
+        saved.insert({node.first.x(), node.first.y()});
+    }
+    std::vector<SCMTerrain::NodeLevel> nodes = snapshot.terrainNodes;
+    for (const auto& node : m_terrain->GetModifiedNodes(true)) {
+        if (saved.count({node.first.x(), node.first.y()})) continue;
+        ChVector3d loc(node.first.x() * m_config.terrainDelta, node.first.y() * m_config.terrainDelta, 0);
+        nodes.push_back({node.first, m_terrain->GetInitHeight(loc)});
+    }
+    m_terrain->SetModifiedNodes(nodes);
+    if (m_renderer) {
+        m_renderer->CollectTerrainChanges(nodes);
+    }
+
+    for (size_t i = 0; i < m_units.size() && i < snapshot.driverInputs.size(); i++) {
+        m_units[i].driver->SetThrottle(snapshot.driverInputs[i].m_throttle);
+        m_units[i].driver->SetSteering(snapshot.driverInputs[i].m_steering);
+        m_units[i].driver->SetBraking(snapshot.driverInputs[i].m_braking);
+    }
+
+    // The LOD assignment is kept; reduced vehicles pick up the restored chassis pose
+    for (auto& unit : m_units) {
+        if (unit.IsReduced()) {
+            unit.lod->SyncFromChassis();
+        }
+    }
+
+    m_stepCount = snapshot.stepCount;
+    m_stepSize = snapshot.stepSize;
+    m_avgContactEvents = 0;
+    m_convergedSteps = 0;
+    PublishState();
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Restored snapshot at t=" << snapshot.vehicle.time << " (" << nodes.size()
+              << " terrain nodes) in " << elapsed * 1e3 << " ms" << std::endl;
+}
+
+void ChronoSimulation::StepPhysics(double step) {
+    double time = m_system->GetChTime();
+
+    // Replay: inputs, step size and solver cap of this step all come from the trace
+    if (m_units[0].replay) {
+        const InputRecord& record = m_units[0].replay->Seek(time);
+        step = record.step;
+        m_stepSize = record.step;
+        SetSolverMaxIterations(record.maxIterations);
+        for (size_t i = 1; i < m_units.size(); i++) {
+            if (m_units[i].replay) m_units[i].replay->Seek(time);
+        }
+    }
+
+    // Get driver inputs
+    for (auto& unit : m_units) {
+        unit.inputs = unit.driver->GetInputs();
+        if (m_recorder && unit.active) {
+            m_recorder->Record({unit.unitId, time, step, GetSolverMaxIterations(), unit.inputs.m_throttle,
+                                unit.inputs.m_steering, unit.inputs.m_braking});
+        }
+    }
+
+    if (m_config.vehicleLod) {
+        UpdateVehicleLod(step);
+    }
+
+    // Vehicles share one system: each vehicle synchronizes and advances its own subsystems
+    // (in parallel when there are several), the system itself is stepped once by the primary
+    // vehicle, which owns it, or by StepBackendSystem() on the Multicore backend. Reduced
+    // vehicles only run their driver and the bicycle model.
+    auto advance_vehicle = [step](VehicleUnit& unit) {
+        if (unit.IsReduced()) {
+            unit.lod->Advance(step, unit.inputs);
+        } else {
+            unit.vehicle->Advance(step);
+        }
+    };
+    if (m_coupling) {
+        // Explicit coupling: SCM steps on the wheel states of this step while the vehicle
+        // integrates it, using the terrain forces computed during the previous step
+        ForEachVehicle([time](VehicleUnit& unit) {
+            unit.driver->Synchronize(time);
+            if (!unit.IsReduced()) {
+                unit.vehicle->Synchronize(time, unit.inputs);
+            }
+        });
+        m_coupling->ApplyForces();
+        m_coupling->BeginStep(step);
+
+        ForEachVehicle([step](VehicleUnit& unit) { unit.driver->Advance(step); });
+        m_vehicle->Advance(step);
+        ForEachVehicle(
+            [step](VehicleUnit& unit) {
+                if (!unit.IsReduced()) unit.vehicle->Advance(step);
+            },
+            true);
+        StepBackendSystem(step);
+        m_coupling->EndStep();
+
+        // Reduced vehicles query the SCM surface, which the terrain step writes until EndStep()
+        ForEachVehicle(
+            [step](VehicleUnit& unit) {
+                if (unit.IsReduced()) unit.lod->Advance(step, unit.inputs);
+            },
+            true);
+    } else {
+        // Update all modules
+        m_terrain->Synchronize(time);
+        ForEachVehicle([this, time](VehicleUnit& unit) {
+            unit.driver->Synchronize(time);
+            if (!unit.IsReduced()) {
+                unit.vehicle->Synchronize(time, unit.inputs, *m_terrain);
             }
+        });
+
+        // Advance simulation
+        ForEachVehicle([step](VehicleUnit& unit) { unit.driver->Advance(step); });
+        m_terrain->Advance(step);
+        m_vehicle->Advance(step);
+        ForEachVehicle(advance_vehicle, true);
+        StepBackendSystem(step);
+    }
+    if (m_vis) {
+        m_vis->Advance(step);
+    }
+    m_stepCount++;
+
+    // A diverged step is replaced by a restored checkpoint, which publishes its own state
+    if (m_watchdog && !CheckStability()) {
+        return;
+    }
+
+    if (m_renderer) {
+        m_renderer->CollectTerrainChanges();
+    }
+
+    PublishState();
+}
+
+void ChronoSimulation::StepBackendSystem(double step) {
+    // A vehicle only steps the system it created; an external backend system is owned by none,
+    // so it is stepped here once every vehicle has advanced its subsystems
+    if (m_backendSystem) {
+        m_system->DoStepDynamics(step);
+    }
+}
+
+bool ChronoSimulation::CheckStability() {
+    StabilityWatchdog::Sample sample;
+    sample.time = m_system->GetChTime();
+    sample.solverResidual = m_system->GetSolver()->AsIterative()->GetError();
+    sample.maxSinkage = GetMaxSinkage();
+
+    std::string reason;
+    for (const auto& unit : m_units) {
+        if (!unit.active) continue;
+        sample.chassis = CaptureVehicleState(unit);
+        reason = m_watchdog->Check(sample);
+        if (!reason.empty()) {
+            if (m_units.size() > 1) {
+                reason = "vehicle " + std::to_string(unit.unitId) + ": " + reason;
+            }
+            break;
         }
-        else if (arg == "--rot" && i + 3 < argc) {
-            try {
-                double roll = std::stod(argv[i + 1]);
-                double pitch = std::stod(argv[i + 2]);
-                double yaw = std::stod(argv[i + 3]);
-                config.initRot = eulerToQuaternion(roll, pitch, yaw);
-                i += 3;
-            } catch (const std::exception& e) {
-                std::cerr << "Error parsing rotation arguments\n";
-                printUsage();
-                return 1;
+    }
+    if (reason.empty()) {
+        if (m_watchdog->CheckpointDue(sample.time)) {
+            m_watchdog->AddCheckpoint(SaveSnapshot());
+        }
+        if (m_watchdog->Recovered(sample.time)) {
+            m_watchdog->ClearRecovery();
+            if (!m_config.adaptiveStep && m_stepSize != m_config.stepSize) {
+                std::cout << "Watchdog: stable again, timestep " << m_stepSize << " -> " << m_config.stepSize
+                          << " at t=" << sample.time << std::endl;
+                m_stepSize = m_config.stepSize;
             }
         }
-        else if (arg == "--z-offset" && i + 1 < argc) {
-            try {
-                float zOffset = std::stof(argv[i + 1]);
-                config.unrealZOfsset = zOffset;
-                i += 1;
-                std::cout << "Setting Unreal Z offset to: " << zOffset << std::endl;
-            } catch (const std::exception& e) {
-                std::cerr << "Error parsing Z offset argument\n";
-                printUsage();
-                return 1;
+        return true;
+    }
+
+    double retry_step;
+    double failed_step = m_stepSize;
+    auto checkpoint = m_watchdog->Rollback(failed_step, retry_step);
+    if (!checkpoint) {
+        throw std::runtime_error("Watchdog: " + reason + " at t=" + std::to_string(sample.time) +
+                                 " and no checkpoint left to roll back to");
+    }
+
+    std::cerr << "Watchdog: " << reason << " at t=" << sample.time << ", rolling back to t="
+              << checkpoint->vehicle.time << " with timestep " << failed_step << " -> " << retry_step << std::endl;
+    RestoreSnapshot(*checkpoint);
+    m_stepSize = retry_step;
+    return false;
+}
+
+double ChronoSimulation::GetMaxSinkage() const {
+    // Depth of the lowest wheel point below the undeformed terrain surface
+    double max_sinkage = 0;
+    for (const auto& unit : m_units) {
+        if (!unit.active) continue;
+        for (auto& axle : unit.vehicle->GetAxles()) {
+            for (auto& wheel : axle->GetWheels()) {
+                ChVector3d pos = wheel->GetSpindle()->GetPos();
+                double bottom = pos.z() - wheel->GetTire()->GetRadius();
+                max_sinkage = std::max(max_sinkage, m_terrain->GetInitHeight(pos) - bottom);
             }
         }
-        else if (arg == "--no-viz") {
-            config.useVisualization = false;
-            std::cout << "Running without visualization" << std::endl;
+    }
+    return max_sinkage;
+}
+
+void ChronoSimulation::PublishState() {
+    StateFrame frame;
+    frame.step = m_stepCount;
+    frame.time = m_system->GetChTime();
+    m_publishedTime = frame.time;
+    for (const auto& unit : m_units) {
+        frame.vehicles.push_back(CaptureVehicleState(unit));
+        frame.unitIds.push_back(unit.unitId);
+    }
+    for (const auto& ghost : m_ghosts) {
+        frame.vehicles.push_back(ghost.second.state);
+        frame.unitIds.push_back(ghost.first);
+    }
+    m_stateBus.Publish(frame);
+}
+
+VehicleState ChronoSimulation::CaptureVehicleState(const VehicleUnit& unit) const {
+    auto chassis = unit.vehicle->GetChassisBody();
+
+    VehicleState state;
+    state.pos = chassis->GetPos();
+    state.rot = chassis->GetRot();
+    state.vel = chassis->GetPosDt();
+    state.acc = chassis->GetPosDt2();
+    state.rotDt = chassis->GetRotDt();
+    return state;
+}
+
+void ChronoSimulation::StartIo() {
+    m_ioRunning = true;
+    m_ioThread = std::thread(&ChronoSimulation::RunIo, this);
+}
+
+void ChronoSimulation::StopIo() {
+    m_ioRunning = false;
+    if (m_ioThread.joinable()) {
+        m_ioThread.join();
+    }
+}
+
+void ChronoSimulation::RunIo() {
+    ThreadBudget::PinCurrentThread(ThreadBudget::Role::IO);
+
+    while (m_ioRunning) {
+        if (!m_ioReader->Update()) {
+            // Nothing new from physics yet
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+            continue;
+        }
+
+        // Pick up rate changes made by the QoS governor on the physics thread
+        if (m_sensorTask >= 0 && m_ioScheduler.GetPeriod(m_sensorTask) != m_sensorPeriod) {
+            m_ioScheduler.SetPeriod(m_sensorTask, m_sensorPeriod);
         }
-        else if (arg == "--help" || arg == "-h") {
-            printUsage();
-            return 0;
+        if (m_poseTask >= 0 && m_ioScheduler.GetPeriod(m_poseTask) != m_posePeriod) {
+            m_ioScheduler.SetPeriod(m_poseTask, m_posePeriod);
         }
+
+        m_ioScheduler.Run(m_ioReader->Front().time);
     }
-    
-    // Print initial configuration
-    std::cout << "Starting simulation with:\n"
-              << "Position: " << config.initLoc.x() << " " 
-              << config.initLoc.y() << " " 
-              << config.initLoc.z() << "\n"
-              << "Rotation (quaternion): " << config.initRot << "\n"
-              << "Unreal Z offset: " << config.unrealZOfsset << std::endl;
-    
-    // Launch simulation
-    SimulationLauncher launcher(config);
-    launcher.Launch();
-    launcher.Join();
-    
-    return 0;
-}
\ No newline at end of file
+}
+
+void ChronoSimulation::PublishPose(const StateFrame& frame) {
+    // Ghosts of neighbouring regions go to the client like local vehicles
+    for (size_t i = 0; i < frame.vehicles.size(); i++) {
+        if (frame.unitIds[i] < 0) continue;
+        const VehicleState& state = frame.vehicles[i];
+        m_tcp_server->updatePositionOfUnit(frame.unitIds[i], state.pos, state.rot, *m_terrain_coords);
+    }
+}
+
+void ChronoSimulation::LogTelemetry(double time) {
+    std::cout << "[Telemetry] t=" << time << " RTF=" << GetRTF() << " step=" << m_stepSize;
+    if (m_qos) {
+        std::cout << " headroom=" << m_qos->GetHeadroom();
+    }
+    std::cout << std::endl;
+    if (m_pacer) {
+        m_pacer->PrintReport(std::cout);
+    }
+}
+
+double ChronoSimulation::GetPosePeriod() const {
+    // With no explicit rate the pose goes out on every I/O cycle
+    return m_config.poseRate > 0 ? 1.0 / m_config.poseRate : 0.0;
+}
+
+void ChronoSimulation::ApplyQosLevels() {
+    if (m_renderTask >= 0) {
+        m_scheduler.SetPeriod(m_renderTask,
+                              1.0 / (m_config.targetFps * m_qos->GetRateScale(QosGovernor::Knob::RENDER)));
+    }
+    m_sensorPeriod = 1.0 / (m_config.sensorRate * m_qos->GetRateScale(QosGovernor::Knob::SENSORS));
+
+    // An unthrottled pose stream sheds to every 2^level cycles
+    double pose_period = GetPosePeriod();
+    if (pose_period <= 0) {
+        pose_period = m_stepSize * m_config.physicsSubsteps;
+    }
+    double pose_scale = m_qos->GetRateScale(QosGovernor::Knob::POSE_STREAM);
+    m_posePeriod = pose_scale < 1 ? pose_period / pose_scale : GetPosePeriod();
+
+    int iterations = (int)(m_config.solverMaxIterations * m_qos->GetRateScale(QosGovernor::Knob::SOLVER));
+    SetSolverMaxIterations(std::max(iterations, 10));
+}
+
+void ChronoSimulation::UpdateTimestep() {
+    if (!m_config.adaptiveStep) return;
+
+    auto solver = m_system->GetSolver()->AsIterative();
+    int iterations = solver->GetIterations();
+    int max_iterations = solver->GetMaxIterations();
+    double residual = solver->GetError();
+
+    // SCM contact is applied as loads, not rigid contacts, so count both
+    double contact_events = m_system->GetNumContacts() + m_terrain->GetNumRayHits();
+    bool contact_spike = m_avgContactEvents > 0 &&
+                         contact_events > m_config.contactSpikeRatio * m_avgContactEvents;
+    m_avgContactEvents = 0.95 * m_avgContactEvents + 0.05 * contact_events;
+
+    double new_step = m_stepSize;
+    const char* reason = nullptr;
+
+    // A cap lowered by the QoS governor saturates by design, so only the nominal cap counts
+    bool saturated = iterations >= max_iterations && max_iterations >= m_config.solverMaxIterations;
+
+    if (saturated || residual > m_config.maxSolverResidual) {
+        new_step = m_stepSize * 0.5;
+        reason = "solver not converging";
+    } else if (contact_spike) {
+        new_step = m_stepSize * 0.5;
+        reason = "contact spike";
+    } else if (iterations < max_iterations / 2) {
+        // Only change the step after a run of well-converged steps
+        if (++m_convergedSteps < 50) return;
+        double rtf = GetRTF();
+        if (rtf > m_targetRTF) {
+            new_step = m_stepSize * 1.2;
+            reason = "behind target RTF";
+        } else if (rtf < 0.8 * m_targetRTF && m_stepSize > m_config.stepSize) {
+            // Enough headroom: give accuracy back by returning toward the nominal step
+            new_step = std::max(m_stepSize / 1.2, m_config.stepSize);
+            reason = "ahead of target RTF";
+        }
+    }
+
+    m_convergedSteps = 0;
+    new_step = std::min(std::max(new_step, m_config.minStepSize), m_config.maxStepSize);
+    if (reason && new_step != m_stepSize) {
+        std::cout << "Timestep " << m_stepSize << " -> " << new_step << " at t=" << m_system->GetChTime()
+                  << " (" << reason << ", iterations=" << iterations << ", residual=" << residual
+                  << ", RTF=" << GetRTF() << ")" << std::endl;
+        m_stepSize = new_step;
+    }
+}
@@ -26,6 +26,25 @@
 #include "terrain_system.hpp"
 
 #include "TcpPositionServer.hpp"
+#include "qos_governor.hpp"
+#include "task_scheduler.hpp"
+#include "realtime_pacer.hpp"
+#include "state_bus.hpp"
+#include "async_renderer.hpp"
+#include "terrain_coupling.hpp"
+#include "trajectory_log.hpp"
+#include "simulation_snapshot.hpp"
+#include "stability_watchdog.hpp"
+#include "input_trace.hpp"
+#include "worker_pool.hpp"
+#include "vehicle_lod.hpp"
+#include "terrain_source.hpp"
+#include "region_exchange.hpp"
+#include <map>
+#include <atomic>
+#include <future>
+#include <mutex>
+#include <thread>
 
 // Driver class for controlling the vehicle
 class MyDriver : public chrono::vehicle::ChDriver {
@@ -39,12 +58,44 @@ private:
     double m_delay;
 };
 
+// Driver whose inputs are set by a lockstep client between steps
+class ExternalDriver : public chrono::vehicle::ChDriver {
+public:
+    ExternalDriver(chrono::vehicle::ChVehicle& vehicle);
+    ~ExternalDriver() {}
+
+    void SetInputs(double throttle, double steering, double braking);
+};
+
+// One vehicle of the world with its own driver, ROS namespace and TCP unit id
+struct VehicleUnit {
+    int index;
+    int unitId;                // Id in TCP packets, -1 while parked in the spawn pool
+    bool active;               // False while parked: bodies fixed out of sight below the terrain
+    std::string rosNamespace;  // Prefix of the cmd_vel, odom and imu topics
+    std::shared_ptr<chrono::vehicle::generic::Generic_Vehicle> vehicle;
+    std::shared_ptr<chrono::vehicle::ChDriver> driver;
+    std::shared_ptr<ExternalDriver> externalDriver;  // Set in lockstep mode, also held by driver
+    std::shared_ptr<ReplayDriver> replay;            // Set when replaying, also held by driver
+    std::shared_ptr<PhysicalSensors> sensors;
+    chrono::vehicle::DriverInputs inputs;            // Inputs applied in the current step
+    std::vector<std::shared_ptr<chrono::ChBody>> bodies;  // Every body the vehicle added to the system
+    std::vector<std::shared_ptr<chrono::ChShaft>> shafts;  // Every powertrain and driveline shaft
+    std::shared_ptr<VehicleLod> lod;                 // Level of detail, not set for the primary vehicle
+
+    bool IsReduced() const { return lod && lod->IsReduced(); }
+};
+
 // Main simulation class
 class ChronoSimulation {
 public:
     // Patch type enum
     enum class PatchType { FLAT, MESH, HEIGHTMAP };
 
+    // Multibody system the vehicles are built on. MULTICORE needs the library built with the
+    // Chrono::Multicore component (CHRONO_BACKEND_MULTICORE).
+    enum class SystemBackend { NSC, MULTICORE };
+
     // Configuration structure
     struct Config {
         // Simulation parameters
@@ -54,11 +105,65 @@ public:
         bool renderWireframe;
         double driverDelay;
         
+        // Adaptive timestep parameters
+        bool adaptiveStep;         // Let UpdateTimestep() vary the step within [minStepSize, maxStepSize]
+        double minStepSize;
+        double maxStepSize;
+        double targetRTF;          // Chrono RTF (wall time / sim time) the controller aims for
+        double maxSolverResidual;  // Shrink the step when the solver ends above this residual
+        double contactSpikeRatio;  // Shrink the step when contact events exceed this multiple of their average
+        int solverMaxIterations;   // Nominal iteration cap of the iterative solver
+
+        // Quality-of-service governor
+        bool qosGovernor;          // Shed render/sensor/pose/solver work when falling behind wall clock
+        QosGovernor::Settings qosSettings;
+        double sensorRate;         // Nominal odometry/IMU publish rate (Hz)
+
+        // Main loop scheduling
+        int physicsSubsteps;       // Physics steps per I/O cycle of the task scheduler
+        double poseRate;           // TCP pose stream rate (Hz, sim time), 0 = every I/O cycle
+        double telemetryPeriod;    // Seconds of sim time between telemetry log lines, 0 = off
+
+        // Realtime pacing
+        bool realtimeMode;         // Use RealtimePacer (sleep-then-spin, deadline accounting) instead of ChRealtimeStepTimer
+        RealtimePacer::Settings realtimeSettings;
+        
         // Vehicle parameters
         chrono::ChVector3d initLoc;
         chrono::ChQuaternion<> initRot;
+        int numVehicles;       // Vehicles sharing the terrain, unit i starts at initLoc + i * vehicleSpacing
+        chrono::ChVector3d vehicleSpacing;  // Offset between start positions (ROS frame, m)
+        int firstUnitId;       // TCP unit id of vehicle 0, the others follow consecutively
+        int vehicleThreads;    // Threads for per-vehicle work, 0 = one per vehicle
+        int spawnPoolSize;     // Pre-built parked vehicles that CreateUnit packets can activate
+        double spawnClearance; // Spawned chassis is placed at least this high (m) above the terrain
+        bool vehicleLod;       // Run vehicles far from the primary one on a kinematic bicycle model
+        VehicleLod::Settings lodSettings;
         bool useTerrainMesh;
         bool useVisualization; // <-- Add this line
+        bool asyncRender;      // Render on a separate thread from double-buffered transforms
+        bool explicitCoupling; // Step SCM concurrently with the vehicle, using one-step-lagged forces
+        std::string terrainNode;  // Explicit coupling with SCM in the terrain process at this address, empty = in-process
+        bool serveTerrain;     // Be the terrain process listening on terrainNode instead of simulating vehicles
+        SystemBackend systemBackend;  // ChSystemNSC with Bullet, or ChSystemMulticoreNSC
+        bool compareBackends;  // Run the scenario on every available backend, report throughput and deviation
+        bool useTcpServer;     // Wait for a UE client and stream poses over TCP
+        int tcpPort;           // Port of the UE / lockstep client connection
+        bool useRos;           // Connect to rosbridge for cmd_vel and sensor topics
+        std::string rosPrefix; // Prepended to every ROS topic (/robot<i>/..., /clock), empty = none
+        bool scriptedDriver;   // Drive with the scripted MyDriver instead of cmd_vel
+        double duration;       // Stop after this much sim time (s), 0 = run until closed
+        std::string trajectoryFile;  // Log the chassis trajectory to this CSV, empty = off
+        double trajectoryRate;       // Trajectory samples per second of sim time
+        bool lockstep;         // Step only on client StepRequest packets, no wall-clock pacing
+        bool externalInputs;   // Drivers take inputs from SetInputs() (in-process stepping via Advance())
+        RegionExchange::Settings regionSettings;  // Split the world across processes (regions > 1)
+        bool watchdog;         // Roll back to a checkpoint with a smaller step when the integration diverges
+        StabilityWatchdog::Settings watchdogSettings;
+        std::string recordInputsFile;  // Write the per-step input trace here, empty = off
+        std::string replayInputsFile;  // Drive from this input trace instead of ROS/script
+        bool freeRun;          // Step as fast as possible instead of pacing to wall clock
+        double clockRate;      // Rate (Hz, sim time) of /clock messages in free-run mode
         
         // Terrain parameters
         chrono::ChVector2d patchSize;
@@ -89,13 +194,45 @@ public:
 
     // Constructor
     ChronoSimulation(const Config& config = Config());
+    ~ChronoSimulation();
     
     // Initialize the simulation
     void Initialize();
     
-    // Run the simulation
+    // Run the simulation. Throws std::runtime_error when the run cannot go on, e.g. the
+    // watchdog has no checkpoint left to roll back to.
     void Run();
+
+    // Ask Run() to return after the current cycle; safe to call from any thread
+    void Stop() { m_stopRequested = true; }
+
+    // Sim time of the last published step; safe to call from any thread
+    double GetSimTime() const { return m_publishedTime; }
+
+    // In-process stepping without Run(): set the inputs of each vehicle (Config::externalInputs),
+    // then advance a number of fixed physics steps. No pacing, TCP or ROS is involved.
+    // Advance() throws like Run() when a step fails.
+    void SetInputs(int vehicle, double throttle, double steering, double braking);
+    void Advance(int steps);
+
+    int GetNumVehicles() const { return (int)m_units.size(); }
+    const chrono::vehicle::ChWheeledVehicle& GetVehicle(int vehicle) const { return *m_units[vehicle].vehicle; }
+    VehicleState GetVehicleState(int vehicle) const { return CaptureVehicleState(m_units[vehicle]); }
+    chrono::ChSystem* GetSystem() const { return m_system; }
+    std::shared_ptr<chrono::vehicle::SCMTerrain> GetTerrain() const { return m_terrain; }
+
+    // Deepest wheel point below the undeformed terrain over all active vehicles (m)
+    double GetMaxSinkage() const;
+
+    // Snapshot of the running simulation for another thread (e.g. to start a RolloutService
+    // query), taken by Run() at the end of the current cycle; the caller waits up to one cycle.
+    // Null if Run() is not running or ends first. On the physics thread (or without Run()) use
+    // SaveSnapshot() instead.
+    std::shared_ptr<const SimulationSnapshot> RequestSnapshot();
     
+    static bool IsBackendAvailable(SystemBackend backend);
+    static const char* GetBackendName(SystemBackend backend);
+
     // Configuration setter
     void SetConfig(const Config& config) { m_config = config; }
     const Config& GetConfig() const { return m_config; }
@@ -103,19 +240,66 @@ public:
     // Add RTF monitoring methods
     double GetRTF() const { return m_vehicle ? m_vehicle->GetRTF() : 0.0; }
     double GetStepRTF() const { return m_vehicle ? m_vehicle->GetStepRTF() : 0.0; }
+    double GetStepSize() const { return m_stepSize; }
+
+    // Capture the complete system, terrain and driver state in memory. Call between steps
+    // (on the physics thread); restoring takes the simulation back to exactly that step.
+    // RestoreSnapshot() throws with a terrain node, whose terrain is not in the snapshot.
+    std::shared_ptr<SimulationSnapshot> SaveSnapshot();
+    void RestoreSnapshot(const SimulationSnapshot& snapshot);
 
 private:
     Config m_config;
     
     // System components
-    chrono::ChSystem* m_system;  // Raw pointer to the system (owned by m_vehicle)
-    std::shared_ptr<chrono::vehicle::generic::Generic_Vehicle> m_vehicle;
+    chrono::ChSystem* m_system;  // Raw pointer to the system (owned by m_vehicle or m_backendSystem)
+    std::shared_ptr<chrono::ChSystem> m_backendSystem;  // Multicore system the vehicles are added to, else null
+    std::shared_ptr<chrono::vehicle::generic::Generic_Vehicle> m_vehicle;  // Unit 0; owns an NSC system
     std::shared_ptr<chrono::vehicle::SCMTerrain> m_terrain;
     std::shared_ptr<chrono::vehicle::ChWheeledVehicleVisualSystemIrrlicht> m_vis;
+    std::shared_ptr<AsyncRenderer> m_renderer;
     std::shared_ptr<TerrainSystemCoordinates> m_terrain_coords;
-    std::shared_ptr<PhysicalSensors> m_sensors;
-    std::shared_ptr<ROSDriver> m_driver;
-    TcpPositionServer m_tcp_server;
+    std::vector<VehicleUnit> m_units;
+    std::shared_ptr<WorkerPool> m_vehiclePool;
+    std::map<int, std::shared_ptr<SimulationSnapshot>> m_snapshots;  // Lockstep snapshot slots
+    std::shared_ptr<StabilityWatchdog> m_watchdog;
+    std::shared_ptr<InputRecorder> m_recorder;
+    std::shared_ptr<TerrainCoupling> m_coupling;
+    std::shared_ptr<TrajectoryLog> m_trajectory;
+    std::shared_ptr<QosGovernor> m_qos;
+    TaskScheduler m_scheduler;     // Physics-thread tasks (render, telemetry)
+    std::shared_ptr<RealtimePacer> m_pacer;
+    int m_renderTask;
+
+    // Per-step state snapshots and the I/O thread that consumes them
+    StateBus m_stateBus;
+    StateBus::Reader* m_ioReader;
+    TaskScheduler m_ioScheduler;   // I/O-thread tasks (sensors, pose stream, clock)
+    std::thread m_ioThread;
+    std::atomic<bool> m_ioRunning;
+    std::atomic<double> m_sensorPeriod;  // Set by the QoS governor, applied by the I/O thread
+    std::atomic<double> m_posePeriod;
+    int m_sensorTask;
+    int m_poseTask;
+    uint64_t m_stepCount;
+    std::shared_ptr<TcpPositionServer> m_tcp_server;
+    std::mutex m_snapshotRequestMutex;
+    std::vector<std::promise<std::shared_ptr<const SimulationSnapshot>>> m_snapshotRequests;
+    bool m_serveSnapshotRequests;  // Run() is in its loop; guarded by m_snapshotRequestMutex
+    std::atomic<bool> m_snapshotRequested;
+
+    // Domain decomposition: vehicles of neighbouring regions near the borders, and handoffs
+    // waiting for the neighbour's answer (unit id -> sim time the request was last sent)
+    struct Ghost {
+        VehicleState state;
+        double received;  // Local sim time
+    };
+    std::shared_ptr<RegionExchange> m_regions;
+    std::map<int, Ghost> m_ghosts;
+    std::map<int, double> m_handoffs;
+    bool m_clientConnected;        // Cleared once the client hangs up; poses are still streamed best-effort
+    std::atomic<bool> m_stopRequested;
+    std::atomic<double> m_publishedTime;
     double last_sleep_time;
     double last_render_sleep_time;
     double z_min_offset;
@@ -123,16 +307,57 @@ private:
     
     // Helper methods
     void SetupVehicle();
+    void CreateMulticoreSystem();
+    void SetSolverMaxIterations(int iterations);
+    int GetSolverMaxIterations() const;
+    std::shared_ptr<chrono::vehicle::generic::Generic_Vehicle> CreateVehicle(chrono::ChSystem* system,
+                                                                               const chrono::ChVector3d& ros_loc);
+    void SetupDrivers();
+    void ForEachVehicle(const std::function<void(VehicleUnit&)>& fn, bool skip_primary = false);
+    VehicleUnit* FindUnit(int unit_id);
+    void UpdateVehicleLod(double step);
+    bool HandleClientPackets();
+    VehicleUnit* FindParkedUnit();
+    bool SpawnUnit(int unit_id, const CreateUnitSendable_t& request);
+    bool AdoptUnit(const RegionExchange::Message& handoff);
+    void ExchangeRegionState();
+    bool DespawnUnit(int unit_id);
+    void ParkUnit(VehicleUnit& unit);
+    void SetUnitActive(VehicleUnit& unit, bool active);
     void SetupTerrain();
     void SetupVisualization();
     void SetupSensors();
 
+    void SetupScheduler();
+    void StepPhysics(double step);
+    bool WaitForClient();
+    bool RunLockstepRequest();
+    bool SendLockstepResponse(const VehicleUnit& unit, uint32_t seq);
+    bool CheckStability();
+    void StepBackendSystem(double step);
+    void EndRun();
+    void ServeSnapshotRequests();
+    void PublishState();
+    VehicleState CaptureVehicleState(const VehicleUnit& unit) const;
+    void StartIo();
+    void StopIo();
+    void RunIo();
+    void PublishPose(const StateFrame& frame);
+    void LogTelemetry(double time);
+    void ApplyQosLevels();
+    double GetPosePeriod() const;
+
     void GetScale();
     double GetSleepTime(bool render);
 
     // Add RTF monitoring variables
     double m_targetRTF;
     void UpdateTimestep();
+
+    // Adaptive timestep state
+    double m_stepSize;           // Step currently used by Run()
+    double m_avgContactEvents;   // Running average of contact events per step
+    int m_convergedSteps;        // Consecutive well-converged steps since the last change
 };
 
 #endif
\ No newline at end of file
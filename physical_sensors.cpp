@@ -4,11 +4,15 @@ using namespace chrono;
 
 PhysicalSensors::PhysicalSensors(vehicle::ChVehicle* vehicle, 
                                 TerrainSystemCoordinates* coord_system,
-                                double update_rate)
+                                bool publish_clock,
+                                const std::string& ns,
+                                const std::string& clock_topic)
     : vehicle_(vehicle)
     , coord_system_(coord_system)
-    , update_interval_(1.0 / update_rate)
-    , last_update_time_(0)
+    , publish_clock_(publish_clock)
+    , odom_topic_(ns + "/odom")
+    , imu_topic_(ns + "/imu")
+    , clock_topic_(clock_topic)
     , last_time_(0) {
     
     if (!ros_bridge_.connect("ws://localhost:9090")) {
@@ -30,7 +34,7 @@ PhysicalSensors::PhysicalSensors(vehicle::ChVehicle* vehicle,
 
 void PhysicalSensors::InitializeTopics() {
     // Advertise odometry first
-    if (!ros_bridge_.advertise("/robot0/odom", ODOM_MSG_TYPE)) {
+    if (!ros_bridge_.advertise(odom_topic_, ODOM_MSG_TYPE)) {
         std::cerr << "Failed to advertise odometry topic" << std::endl;
         return;
     }
@@ -39,31 +43,33 @@ void PhysicalSensors::InitializeTopics() {
     std::this_thread::sleep_for(std::chrono::milliseconds(500));
     
     // Advertise IMU second
-    if (!ros_bridge_.advertise("/robot0/imu", IMU_MSG_TYPE)) {
+    if (!ros_bridge_.advertise(imu_topic_, IMU_MSG_TYPE)) {
         std::cerr << "Failed to advertise IMU topic" << std::endl;
         return;
     }
     
-    // Wait another half second to ensure both topics are fully registered
+    // Advertise simulation clock when sim time is decoupled from wall clock
+    if (publish_clock_ && !ros_bridge_.advertise(clock_topic_, CLOCK_MSG_TYPE)) {
+        std::cerr << "Failed to advertise clock topic" << std::endl;
+        return;
+    }
+
+    // Wait another half second to ensure all topics are fully registered
     std::this_thread::sleep_for(std::chrono::milliseconds(500));
     
     topics_initialized_ = true;
     std::cout << "ROS topics successfully advertised" << std::endl;
 }
 
-void PhysicalSensors::Update(double time) {
+void PhysicalSensors::Update(double time, const VehicleState& state) {
     if (!topics_initialized_) return;
-    if (time - last_update_time_ >= update_interval_) {
-        PublishOdometry(time);
-        PublishIMU(time);
-        last_update_time_ = time;
-    }
+    PublishOdometry(time, state);
+    PublishIMU(time, state);
 }
 
-void PhysicalSensors::PublishOdometry(double time) {
-    auto chassis = vehicle_->GetChassisBody();
-    auto pos = chassis->GetPos();
-    auto rot = chassis->GetRot();
+void PhysicalSensors::PublishOdometry(double time, const VehicleState& state) {
+    auto pos = state.pos;
+    auto rot = state.rot;
     
     // Convert rotation quaternion to Euler angles (roll, pitch, yaw)
     double q0 = rot.e0();  // scalar part
@@ -85,9 +91,9 @@ void PhysicalSensors::PublishOdometry(double time) {
     ChVector3d euler_angles(roll, pitch, yaw);
     ChVector3d ros_euler_angles = coord_system_->convertChronotToROSRotation(euler_angles);
     
-    // Calculate velocities using correct methods from ChFrameMoving
-    ChVector3d vel = chassis->GetPosDt();      // Linear velocity
-    ChQuaternion<> rotDt = chassis->GetRotDt(); // Rotational velocity as quaternion
+    // Velocities captured from ChFrameMoving by the physics thread
+    ChVector3d vel = state.vel;             // Linear velocity
+    ChQuaternion<> rotDt = state.rotDt;     // Rotational velocity as quaternion
     
     // Convert to ROS coordinate system using the same transformation as TCP server
     ChVector3d ros_pos = coord_system_->convertChronoToROS(pos);
@@ -159,30 +165,28 @@ void PhysicalSensors::PublishOdometry(double time) {
         }}
     };
     
-    ros_bridge_.publish("/robot0/odom", ODOM_MSG_TYPE, odom_msg);
+    ros_bridge_.publish(odom_topic_, ODOM_MSG_TYPE, odom_msg);
 }
 
-void PhysicalSensors::PublishIMU(double time) {
-    auto chassis = vehicle_->GetChassisBody();
-    
-    // Get acceleration using correct methods from ChFrameMoving
-    ChVector3d acc = chassis->GetPosDt2();     // Linear acceleration
+void PhysicalSensors::PublishIMU(double time, const VehicleState& state) {
+    // Acceleration captured from ChFrameMoving by the physics thread
+    ChVector3d acc = state.acc;     // Linear acceleration
     
     // Add gravity vector in global frame (approximately 9.81 m/s^2 downward)
     ChVector3d gravity(0, 0, 9.81);
     
     // Transform gravity to vehicle's local frame using quaternion rotation
-    ChQuaternion<> rot = chassis->GetRot();
+    ChQuaternion<> rot = state.rot;
     ChVector3d local_gravity = rot.RotateBack(gravity);
     
     // Add local gravity to acceleration
     acc += local_gravity;
 
     //std::cout << "Linear acceleration (with gravity): " << acc << std::endl;
-    ChQuaternion<> rotDt = chassis->GetRotDt(); // Rotational velocity as quaternion
+    ChQuaternion<> rotDt = state.rotDt; // Rotational velocity as quaternion
     
     // Convert quaternion velocity to angular velocity
-    ChVector3d ang_vel = 2.0 * (rotDt * chassis->GetRot().GetConjugate()).GetVector();
+    ChVector3d ang_vel = 2.0 * (rotDt * rot.GetConjugate()).GetVector();
     
     // Convert to ROS coordinate system
     ChVector3d ros_acc = coord_system_->convertChronoToROSDirection(acc);
@@ -215,5 +219,18 @@ void PhysicalSensors::PublishIMU(double time) {
         }}
     };
     
-    ros_bridge_.publish("/robot0/imu", IMU_MSG_TYPE, imu_msg);
+    ros_bridge_.publish(imu_topic_, IMU_MSG_TYPE, imu_msg);
+}
+
+void PhysicalSensors::PublishClock(double time) {
+    if (!topics_initialized_ || !publish_clock_) return;
+
+    json clock_msg = {
+        {"clock", {
+            {"sec", (int)time},
+            {"nanosec", (int)((time - (int)time) * 1e9)}
+        }}
+    };
+
+    ros_bridge_.publish(clock_topic_, CLOCK_MSG_TYPE, clock_msg);
 }
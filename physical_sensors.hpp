@@ -4,26 +4,33 @@
 #include "chrono_vehicle/ChVehicle.h"
 #include "ros_bridge.hpp"
 #include "terrain_system.hpp"
+#include "state_bus.hpp"
 #include <mutex>
 
 class PhysicalSensors {
 public:
     PhysicalSensors(chrono::vehicle::ChVehicle* vehicle, 
                     TerrainSystemCoordinates* coord_system,
-                    double update_rate = 50.0);  // 50 Hz default
+                    bool publish_clock = false,  // Advertise /clock for use_sim_time nodes
+                    const std::string& ns = "/robot0",  // Prefix of the odom and imu topics
+                    const std::string& clock_topic = "/clock");
     
-    void Update(double time);
+    // Publish odometry and IMU from a physics snapshot; the caller's task scheduler decides the rate
+    void Update(double time, const VehicleState& state);
+    void PublishClock(double time);
 
 private:
-    void PublishOdometry(double time);
-    void PublishIMU(double time);
+    void PublishOdometry(double time, const VehicleState& state);
+    void PublishIMU(double time, const VehicleState& state);
     void InitializeTopics();
 
     chrono::vehicle::ChVehicle* vehicle_;
     TerrainSystemCoordinates* coord_system_;
     ROSBridge ros_bridge_;
-    double update_interval_;
-    double last_update_time_;
+    bool publish_clock_;
+    std::string odom_topic_;
+    std::string imu_topic_;
+    std::string clock_topic_;
     
     // Previous state for velocity calculation
     chrono::ChVector3d last_position_;
@@ -32,4 +39,5 @@ private:
     bool topics_initialized_ = false;
     const std::string ODOM_MSG_TYPE = "nav_msgs/Odometry";
     const std::string IMU_MSG_TYPE = "sensor_msgs/Imu";
+    const std::string CLOCK_MSG_TYPE = "rosgraph_msgs/Clock";
 };
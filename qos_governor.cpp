@@ -0,0 +1,83 @@
+#include "qos_governor.hpp"
+#include <iostream>
+
+QosGovernor::Settings::Settings()
+    : order({Knob::RENDER, Knob::POSE_STREAM, Knob::SENSORS, Knob::SOLVER})
+    , maxLevel(3)
+    , degradeHeadroom(1.05)
+    , restoreHeadroom(1.5)
+    , degradeHold(0.25)
+    , restoreHold(2.0) {}
+
+QosGovernor::QosGovernor(const Settings& settings)
+    : settings_(settings)
+    , headroom_(1.0)
+    , low_since_(-1)
+    , high_since_(-1) {}
+
+bool QosGovernor::Update(double time, double step_wall_time, double step_size) {
+    // Headroom > 1 means the step took less wall time than it simulated
+    double headroom = step_wall_time > 0 ? step_size / step_wall_time : settings_.restoreHeadroom * 2;
+    headroom_ = 0.98 * headroom_ + 0.02 * headroom;
+
+    if (headroom_ < settings_.degradeHeadroom) {
+        high_since_ = -1;
+        if (low_since_ < 0) low_since_ = time;
+        if (time - low_since_ < settings_.degradeHold) return false;
+        low_since_ = time;
+
+        for (Knob knob : settings_.order) {
+            if (GetLevel(knob) < settings_.maxLevel) {
+                SetLevel(knob, GetLevel(knob) + 1, time);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    low_since_ = -1;
+    if (headroom_ > settings_.restoreHeadroom) {
+        if (high_since_ < 0) high_since_ = time;
+        if (time - high_since_ < settings_.restoreHold) return false;
+        high_since_ = time;
+
+        for (auto it = settings_.order.rbegin(); it != settings_.order.rend(); ++it) {
+            if (GetLevel(*it) > 0) {
+                SetLevel(*it, GetLevel(*it) - 1, time);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    high_since_ = -1;
+    return false;
+}
+
+void QosGovernor::SetLevel(Knob knob, int level, double time) {
+    int old_level = GetLevel(knob);
+    levels_[static_cast<int>(knob)] = level;
+    std::cout << "[QoS] t=" << time << " headroom=" << headroom_ << " " << KnobName(knob)
+              << " level " << old_level << " -> " << level << " (rate x" << GetRateScale(knob) << ")"
+              << std::endl;
+}
+
+const char* QosGovernor::KnobName(Knob knob) {
+    switch (knob) {
+        case Knob::RENDER: return "render";
+        case Knob::SENSORS: return "sensors";
+        case Knob::POSE_STREAM: return "pose";
+        case Knob::SOLVER: return "solver";
+    }
+    return "unknown";
+}
+
+bool QosGovernor::ParseKnob(const std::string& name, Knob& knob) {
+    for (Knob k : {Knob::RENDER, Knob::SENSORS, Knob::POSE_STREAM, Knob::SOLVER}) {
+        if (name == KnobName(k)) {
+            knob = k;
+            return true;
+        }
+    }
+    return false;
+}
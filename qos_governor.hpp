@@ -0,0 +1,46 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Sheds optional per-step work when the simulation cannot keep up with wall clock.
+// Each knob (render, sensors, pose stream, solver) has a level; level n runs that
+// work at 1/2^n of its nominal rate or budget. Knobs are degraded one level at a
+// time in the configured priority order and restored in reverse order.
+class QosGovernor {
+public:
+    enum class Knob { RENDER, SENSORS, POSE_STREAM, SOLVER };
+
+    struct Settings {
+        std::vector<Knob> order;  // Degradation priority, first knob is shed first
+        int maxLevel;             // Deepest level per knob (rate scale 1/2^maxLevel)
+        double degradeHeadroom;   // Degrade while smoothed headroom stays below this
+        double restoreHeadroom;   // Restore while smoothed headroom stays above this
+        double degradeHold;       // Sim time (s) headroom must stay low before degrading
+        double restoreHold;       // Sim time (s) headroom must stay high before restoring
+
+        Settings();
+    };
+
+    QosGovernor(const Settings& settings = Settings());
+
+    // Feed one step: sim time, wall time spent computing the step, and the step size.
+    // Returns true if any knob level changed.
+    bool Update(double time, double step_wall_time, double step_size);
+
+    int GetLevel(Knob knob) const { return levels_[static_cast<int>(knob)]; }
+    double GetRateScale(Knob knob) const { return 1.0 / (1 << GetLevel(knob)); }
+    double GetHeadroom() const { return headroom_; }
+
+    static const char* KnobName(Knob knob);
+    static bool ParseKnob(const std::string& name, Knob& knob);
+
+private:
+    void SetLevel(Knob knob, int level, double time);
+
+    Settings settings_;
+    int levels_[4] = {0, 0, 0, 0};
+    double headroom_;
+    double low_since_;
+    double high_since_;
+};
@@ -0,0 +1,124 @@
+#include "realtime_pacer.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <thread>
+
+constexpr std::array<double, 7> RealtimePacer::kOverrunBinsMs;
+
+RealtimePacer::Settings::Settings()
+    : spinThreshold(200e-6)
+    , priority(0)
+    , lockMemory(false)
+    , cpu(-1) {}
+
+RealtimePacer::RealtimePacer(const Settings& settings)
+    : settings_(settings)
+    , started_(false)
+    , steps_(0)
+    , misses_(0)
+    , total_overrun_(0)
+    , max_overrun_(0)
+    , max_wake_latency_(0) {
+    histogram_.fill(0);
+}
+
+void RealtimePacer::ConfigureCurrentThread() {
+    if (settings_.lockMemory) {
+        if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+            std::cerr << "mlockall failed: " << strerror(errno) << std::endl;
+        } else {
+            std::cout << "Locked process memory" << std::endl;
+        }
+    }
+
+    if (settings_.priority > 0) {
+        sched_param param{};
+        param.sched_priority = settings_.priority;
+        int err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (err != 0) {
+            std::cerr << "Failed to set SCHED_FIFO priority " << settings_.priority << ": " << strerror(err)
+                      << std::endl;
+        } else {
+            std::cout << "Physics thread running SCHED_FIFO at priority " << settings_.priority << std::endl;
+        }
+    }
+
+    if (settings_.cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(settings_.cpu, &set);
+        int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (err != 0) {
+            std::cerr << "Failed to pin physics thread to CPU " << settings_.cpu << ": " << strerror(err)
+                      << std::endl;
+        } else {
+            std::cout << "Physics thread pinned to CPU " << settings_.cpu << std::endl;
+        }
+    }
+}
+
+void RealtimePacer::Spin(double step) {
+    auto now = Clock::now();
+    if (!started_) {
+        deadline_ = now;
+        started_ = true;
+    }
+    deadline_ += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(step));
+    steps_++;
+
+    if (now > deadline_) {
+        // Missed: record the overrun and restart the cadence from now instead of bursting to catch up
+        double overrun = std::chrono::duration<double>(now - deadline_).count();
+        misses_++;
+        total_overrun_ += overrun;
+        max_overrun_ = std::max(max_overrun_, overrun);
+
+        size_t bin = 0;
+        while (bin < kOverrunBinsMs.size() && overrun * 1e3 >= kOverrunBinsMs[bin]) bin++;
+        histogram_[bin]++;
+
+        deadline_ = now;
+        return;
+    }
+
+    // Coarse sleep, then spin through the last stretch where the scheduler wakeup is unreliable
+    auto spin_start = deadline_ - std::chrono::duration_cast<Clock::duration>(
+                                      std::chrono::duration<double>(settings_.spinThreshold));
+    if (now < spin_start) {
+        std::this_thread::sleep_until(spin_start);
+    }
+    while (Clock::now() < deadline_) {
+    }
+
+    double wake_latency = std::chrono::duration<double>(Clock::now() - deadline_).count();
+    max_wake_latency_ = std::max(max_wake_latency_, wake_latency);
+}
+
+void RealtimePacer::PrintReport(std::ostream& os) const {
+    os << "[Realtime] steps=" << steps_ << " misses=" << misses_;
+    if (steps_ > 0) {
+        os << " (" << 100.0 * misses_ / steps_ << "%)";
+    }
+    if (misses_ > 0) {
+        os << " mean overrun=" << 1e3 * total_overrun_ / misses_ << "ms"
+           << " max overrun=" << 1e3 * max_overrun_ << "ms";
+    }
+    os << " max wake latency=" << 1e6 * max_wake_latency_ << "us" << std::endl;
+
+    if (misses_ == 0) return;
+    os << "[Realtime] overrun histogram:";
+    double lower = 0;
+    for (size_t i = 0; i < histogram_.size(); i++) {
+        if (i < kOverrunBinsMs.size()) {
+            os << " [" << lower << "," << kOverrunBinsMs[i] << ")ms=" << histogram_[i];
+            lower = kOverrunBinsMs[i];
+        } else {
+            os << " >=" << lower << "ms=" << histogram_[i];
+        }
+    }
+    os << std::endl;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+
+// Low-jitter replacement for ChRealtimeStepTimer. Deadlines are absolute, so a late
+// step does not shift the cadence of the following ones. The wait sleeps until shortly
+// before the deadline and busy-spins the remainder. Every deadline miss is counted and
+// its overrun length binned into a histogram.
+class RealtimePacer {
+public:
+    struct Settings {
+        double spinThreshold;  // Busy-spin this long (s) before each deadline instead of sleeping
+        int priority;          // SCHED_FIFO priority for the physics thread, 0 keeps the default policy
+        bool lockMemory;       // mlockall() current and future pages
+        int cpu;               // Pin the physics thread to this CPU, -1 leaves affinity unchanged
+
+        Settings();
+    };
+
+    // Upper bounds (ms) of the overrun histogram bins; the last bin is open-ended
+    static constexpr std::array<double, 7> kOverrunBinsMs = {0.1, 0.5, 1.0, 2.0, 5.0, 10.0, 50.0};
+
+    RealtimePacer(const Settings& settings = Settings());
+
+    // Apply scheduling class, memory locking and pinning to the calling thread
+    void ConfigureCurrentThread();
+
+    // Wait for the deadline one step after the previous one
+    void Spin(double step);
+
+    uint64_t GetSteps() const { return steps_; }
+    uint64_t GetMisses() const { return misses_; }
+    double GetMaxOverrun() const { return max_overrun_; }
+    double GetMaxWakeLatency() const { return max_wake_latency_; }
+
+    void PrintReport(std::ostream& os) const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    Settings settings_;
+    bool started_;
+    Clock::time_point deadline_;
+
+    uint64_t steps_;
+    uint64_t misses_;
+    double total_overrun_;
+    double max_overrun_;
+    double max_wake_latency_;
+    std::array<uint64_t, kOverrunBinsMs.size() + 1> histogram_;
+};
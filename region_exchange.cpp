@@ -0,0 +1,209 @@
+#include "region_exchange.hpp"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace chrono;
+
+namespace {
+const uint32_t kMagic = 0x52474e33;  // "RGN3"
+const size_t kMaxDatagram = 65507;
+
+#pragma pack(push, 1)
+struct WireHeader {
+    uint32_t magic;
+    uint8_t type;
+    int32_t region;
+    int32_t unitId;
+    int32_t vehicle;
+    uint32_t bodies;
+    uint32_t shafts;
+    int32_t gear;
+    double time;
+    double inputs[3];
+};
+
+struct WireBody {
+    double pos[3];
+    double rot[4];
+    double vel[3];
+    double angVel[3];
+};
+
+struct WireShaft {
+    double pos;
+    double speed;
+};
+#pragma pack(pop)
+}  // namespace
+
+RegionExchange::Settings::Settings()
+    : regions(1), index(0), basePort(17900), hosts{"127.0.0.1"}, ghostMargin(20.0), hysteresis(2.0) {}
+
+RegionExchange::RegionExchange(const Settings& settings, double xMin, double xMax)
+    : settings_(settings), x_min_(xMin), x_max_(xMax), socket_(-1) {
+    for (int i = 0; i < settings_.regions; i++) {
+        sockaddr_in peer{};
+        peer.sin_family = AF_INET;
+        peer.sin_port = htons(settings_.basePort + i);
+        const std::string& host = settings_.hosts.size() > (size_t)i ? settings_.hosts[i] : settings_.hosts[0];
+        if (inet_pton(AF_INET, host.c_str(), &peer.sin_addr) != 1) {
+            std::cerr << "Region " << i << ": invalid address " << host << std::endl;
+        }
+        peers_.push_back(peer);
+    }
+}
+
+RegionExchange::~RegionExchange() {
+    if (socket_ >= 0) {
+        close(socket_);
+    }
+}
+
+bool RegionExchange::Open() {
+    socket_ = socket(AF_INET, SOCK_DGRAM, 0);
+    if (socket_ < 0) {
+        std::cerr << "Failed to create region socket." << std::endl;
+        return false;
+    }
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = INADDR_ANY;
+    address.sin_port = htons(settings_.basePort + settings_.index);
+    if (bind(socket_, (struct sockaddr*)&address, sizeof(address)) < 0) {
+        std::cerr << "Failed to bind region socket to port " << settings_.basePort + settings_.index << std::endl;
+        return false;
+    }
+    int flags = fcntl(socket_, F_GETFL, 0);
+    fcntl(socket_, F_SETFL, flags | O_NONBLOCK);
+
+    std::cout << "Region " << settings_.index << "/" << settings_.regions << ": x in [" << Lower(settings_.index)
+              << ", " << Upper(settings_.index) << "), UDP port " << settings_.basePort + settings_.index
+              << std::endl;
+    return true;
+}
+
+double RegionExchange::Lower(int region) const {
+    return x_min_ + (x_max_ - x_min_) * region / settings_.regions;
+}
+
+double RegionExchange::Upper(int region) const {
+    return x_min_ + (x_max_ - x_min_) * (region + 1) / settings_.regions;
+}
+
+int RegionExchange::RegionOf(double x) const {
+    int region = (int)((x - x_min_) / (x_max_ - x_min_) * settings_.regions);
+    return std::min(std::max(region, 0), settings_.regions - 1);
+}
+
+int RegionExchange::HandoffTarget(double x) const {
+    // The outer edges of the first and last strip are not borders
+    int index = settings_.index;
+    bool below = index > 0 && x < Lower(index) - settings_.hysteresis;
+    bool above = index < settings_.regions - 1 && x >= Upper(index) + settings_.hysteresis;
+    return below || above ? RegionOf(x) : -1;
+}
+
+std::vector<int> RegionExchange::GhostTargets(double x) const {
+    std::vector<int> targets;
+    int index = settings_.index;
+    if (index > 0 && x < Lower(index) + settings_.ghostMargin) {
+        targets.push_back(index - 1);
+    }
+    if (index < settings_.regions - 1 && x >= Upper(index) - settings_.ghostMargin) {
+        targets.push_back(index + 1);
+    }
+    return targets;
+}
+
+void RegionExchange::Send(int region, const Message& message) {
+    if (socket_ < 0 || region < 0 || region >= settings_.regions) return;
+
+    WireHeader header;
+    header.magic = kMagic;
+    header.type = static_cast<uint8_t>(message.type);
+    header.region = settings_.index;
+    header.unitId = message.unitId;
+    header.vehicle = message.vehicle;
+    header.bodies = (uint32_t)message.bodies.size();
+    header.shafts = (uint32_t)message.shafts.size();
+    header.gear = message.gear;
+    header.time = message.time;
+    header.inputs[0] = message.throttle;
+    header.inputs[1] = message.steering;
+    header.inputs[2] = message.braking;
+
+    size_t shafts_offset = sizeof(header) + message.bodies.size() * sizeof(WireBody);
+    std::vector<uint8_t> buffer(shafts_offset + message.shafts.size() * sizeof(WireShaft));
+    memcpy(buffer.data(), &header, sizeof(header));
+    for (size_t i = 0; i < message.bodies.size(); i++) {
+        const BodyState& body = message.bodies[i];
+        WireBody wire = {{body.pos.x(), body.pos.y(), body.pos.z()},
+                         {body.rot.e0(), body.rot.e1(), body.rot.e2(), body.rot.e3()},
+                         {body.vel.x(), body.vel.y(), body.vel.z()},
+                         {body.angVel.x(), body.angVel.y(), body.angVel.z()}};
+        memcpy(buffer.data() + sizeof(header) + i * sizeof(WireBody), &wire, sizeof(wire));
+    }
+    for (size_t i = 0; i < message.shafts.size(); i++) {
+        WireShaft wire = {message.shafts[i].pos, message.shafts[i].speed};
+        memcpy(buffer.data() + shafts_offset + i * sizeof(WireShaft), &wire, sizeof(wire));
+    }
+
+    // Best effort: lost ghosts are replaced next cycle, lost handoffs and replies are retried
+    const sockaddr_in& peer = peers_[region];
+    sendto(socket_, buffer.data(), buffer.size(), 0, (const struct sockaddr*)&peer, sizeof(peer));
+}
+
+std::vector<RegionExchange::Message> RegionExchange::Receive() {
+    std::vector<Message> messages;
+    if (socket_ < 0) return messages;
+
+    std::vector<uint8_t> buffer(kMaxDatagram);
+    while (true) {
+        ssize_t size = recv(socket_, buffer.data(), buffer.size(), 0);
+        if (size < 0) break;
+        if ((size_t)size < sizeof(WireHeader)) continue;
+
+        WireHeader header;
+        memcpy(&header, buffer.data(), sizeof(header));
+        size_t shafts_offset = sizeof(header) + (size_t)header.bodies * sizeof(WireBody);
+        if (header.magic != kMagic || (size_t)size != shafts_offset + (size_t)header.shafts * sizeof(WireShaft)) {
+            std::cerr << "Region " << settings_.index << ": dropping malformed datagram" << std::endl;
+            continue;
+        }
+
+        Message message;
+        message.type = static_cast<MessageType>(header.type);
+        message.region = header.region;
+        message.unitId = header.unitId;
+        message.vehicle = header.vehicle;
+        message.time = header.time;
+        message.throttle = header.inputs[0];
+        message.steering = header.inputs[1];
+        message.braking = header.inputs[2];
+        message.gear = header.gear;
+        for (uint32_t i = 0; i < header.bodies; i++) {
+            WireBody wire;
+            memcpy(&wire, buffer.data() + sizeof(header) + i * sizeof(WireBody), sizeof(wire));
+            BodyState body;
+            body.pos = ChVector3d(wire.pos[0], wire.pos[1], wire.pos[2]);
+            body.rot = ChQuaternion<>(wire.rot[0], wire.rot[1], wire.rot[2], wire.rot[3]);
+            body.vel = ChVector3d(wire.vel[0], wire.vel[1], wire.vel[2]);
+            body.angVel = ChVector3d(wire.angVel[0], wire.angVel[1], wire.angVel[2]);
+            message.bodies.push_back(body);
+        }
+        for (uint32_t i = 0; i < header.shafts; i++) {
+            WireShaft wire;
+            memcpy(&wire, buffer.data() + shafts_offset + i * sizeof(WireShaft), sizeof(wire));
+            message.shafts.push_back({wire.pos, wire.speed});
+        }
+        messages.push_back(message);
+    }
+    return messages;
+}
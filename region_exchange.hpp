@@ -0,0 +1,97 @@
+#pragma once
+
+#include <netinet/in.h>
+#include <string>
+#include <vector>
+
+#include "chrono/core/ChQuaternion.h"
+#include "chrono/core/ChVector3.h"
+
+// Spatial domain decomposition of the world across processes. The terrain is split along the
+// Chrono X axis into equal strips, one per process, each of which loads the same terrain and
+// simulates the vehicles inside its strip. Processes talk over UDP:
+//
+//  - Ghost: chassis state of a vehicle within the ghost margin of a border, sent every cycle to
+//    the neighbour so it can show the vehicle to its own client.
+//  - Handoff: complete body and shaft states, transmission gear and driver inputs of a vehicle
+//    that left the strip. The receiver activates its parked copy of the same fleet slot in
+//    that state and answers Accept, after which the sender parks its copy; Reject (slot still
+//    busy) leaves the vehicle with the sender, which retries later.
+//
+// Every region builds the same fleet slots (vehicles and spawn pool), activates only the
+// vehicles that start in its strip and parks the rest. A slot keeps its unit id and its
+// /robot<slot> ROS namespace in every region, so a handed-off vehicle stays addressable under
+// the same names. All regions must run the same build with the same vehicle and terrain
+// options, since body and shaft states are matched by order and sent in host byte order.
+class RegionExchange {
+public:
+    struct Settings {
+        int regions;                     // Strips the world is split into, 1 = no decomposition
+        int index;                       // Strip owned by this process
+        int basePort;                    // Region i receives on UDP basePort + i
+        std::vector<std::string> hosts;  // Address of each region, or one address for all
+        double ghostMargin;              // Vehicles this close to a border are mirrored across it (m)
+        double hysteresis;               // A vehicle is handed off this far past the border (m)
+
+        Settings();
+    };
+
+    enum class MessageType : uint8_t { Ghost = 0, Handoff = 1, Accept = 2, Reject = 3 };
+
+    struct BodyState {
+        chrono::ChVector3d pos;
+        chrono::ChQuaternion<> rot;
+        chrono::ChVector3d vel;
+        chrono::ChVector3d angVel;  // Angular velocity in the absolute frame
+    };
+
+    struct ShaftState {
+        double pos;    // Angle (rad)
+        double speed;  // Angular velocity (rad/s)
+    };
+
+    struct Message {
+        MessageType type = MessageType::Ghost;
+        int region = -1;   // Sender
+        int unitId = -1;
+        int vehicle = -1;  // Fleet slot (VehicleUnit::index), the same in every region
+        double time = 0;   // Sender sim time
+        double throttle = 0;
+        double steering = 0;
+        double braking = 0;
+        std::vector<BodyState> bodies;  // All vehicle bodies for a handoff, the chassis for a ghost
+        std::vector<ShaftState> shafts;  // All powertrain and driveline shafts for a handoff
+        int gear = 0;                    // Transmission gear for a handoff
+    };
+
+    // The strips divide [xMin, xMax]; positions outside belong to the first or last strip
+    RegionExchange(const Settings& settings, double xMin, double xMax);
+    ~RegionExchange();
+
+    // Bind the receive socket; false on error
+    bool Open();
+
+    int GetIndex() const { return settings_.index; }
+    int RegionOf(double x) const;
+
+    // Region that should own a vehicle of this region at x, with hysteresis; -1 to keep it
+    int HandoffTarget(double x) const;
+
+    // Neighbours within the ghost margin of x
+    std::vector<int> GhostTargets(double x) const;
+
+    void Send(int region, const Message& message);
+
+    // Everything received since the last call; does not block
+    std::vector<Message> Receive();
+
+private:
+    double Lower(int region) const;
+    double Upper(int region) const;
+
+    Settings settings_;
+    double x_min_;
+    double x_max_;
+    int socket_;
+    std::vector<sockaddr_in> peers_;
+};
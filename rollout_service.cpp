@@ -0,0 +1,160 @@
+#include "rollout_service.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+using namespace chrono;
+
+RolloutService::Settings::Settings() : workers(4) {}
+
+RolloutService::RolloutService(const ChronoSimulation::Config& config, const Settings& settings)
+    : settings_(settings), stop_(false) {
+    // Same vehicles, spawn pool and coupling as the live run so its snapshots fit; everything
+    // that talks to the outside or paces to wall clock is off
+    ChronoSimulation::Config worker_config = config;
+    worker_config.externalInputs = true;
+    worker_config.useTcpServer = false;
+    worker_config.lockstep = false;
+    worker_config.useRos = false;
+    worker_config.useVisualization = false;
+    worker_config.realtimeMode = false;
+    worker_config.adaptiveStep = false;
+    worker_config.qosGovernor = false;
+    worker_config.watchdog = false;
+    worker_config.vehicleLod = false;
+    worker_config.regionSettings.regions = 1;
+    worker_config.terrainNode.clear();
+    worker_config.recordInputsFile.clear();
+    worker_config.replayInputsFile.clear();
+    worker_config.trajectoryFile.clear();
+
+    auto start = std::chrono::steady_clock::now();
+    int workers = std::max(settings_.workers, 1);
+    for (int i = 0; i < workers; i++) {
+        auto sim = std::make_unique<ChronoSimulation>(worker_config);
+        sim->Initialize();
+        sim->GetSystem()->SetNumThreads(1, 1, 1);
+        free_.push_back(sim.get());
+        sims_.push_back(std::move(sim));
+    }
+    pool_ = std::make_unique<WorkerPool>(workers);
+    dispatcher_ = std::thread(&RolloutService::DispatchLoop, this);
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Rollout service: " << workers << " workers ready in " << elapsed << " s" << std::endl;
+}
+
+RolloutService::~RolloutService() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    dispatcher_.join();
+}
+
+std::future<std::vector<RolloutService::Result>> RolloutService::Submit(
+    std::shared_ptr<const SimulationSnapshot> start, const std::vector<Candidate>& candidates) {
+    auto job = std::make_unique<Job>();
+    job->start = start;
+    job->candidates = candidates;
+    auto future = job->promise.get_future();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        jobs_.push_back(std::move(job));
+    }
+    cv_.notify_one();
+    return future;
+}
+
+std::vector<RolloutService::Result> RolloutService::Evaluate(std::shared_ptr<const SimulationSnapshot> start,
+                                                             const std::vector<Candidate>& candidates) {
+    return Submit(start, candidates).get();
+}
+
+void RolloutService::DispatchLoop() {
+    while (true) {
+        std::unique_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return stop_ || !jobs_.empty(); });
+            if (jobs_.empty()) return;
+            job = std::move(jobs_.front());
+            jobs_.pop_front();
+        }
+
+        // At most one candidate per pool thread runs at a time, and there is one worker
+        // simulation per pool thread, so a free one is always available
+        std::vector<Result> results(job->candidates.size());
+        pool_->ParallelFor(0, (int)job->candidates.size(), [&](int i) {
+            ChronoSimulation* sim;
+            {
+                std::lock_guard<std::mutex> lock(free_mutex_);
+                sim = free_.back();
+                free_.pop_back();
+            }
+            // A failed candidate reports its error and must not lose the worker or reach the
+            // dispatcher thread, which has nobody to hand an exception to
+            try {
+                results[i] = Rollout(*sim, *job->start, job->candidates[i]);
+            } catch (const std::exception& e) {
+                results[i] = Result();
+                results[i].error = e.what();
+            } catch (...) {
+                results[i] = Result();
+                results[i].error = "unknown error";
+            }
+            std::lock_guard<std::mutex> lock(free_mutex_);
+            free_.push_back(sim);
+        });
+        job->promise.set_value(std::move(results));
+    }
+}
+
+RolloutService::Result RolloutService::Rollout(ChronoSimulation& sim, const SimulationSnapshot& start,
+                                               const Candidate& candidate) const {
+    Result result;
+    auto wall_start = std::chrono::steady_clock::now();
+
+    if ((unsigned int)start.vehicle.x.size() != sim.GetSystem()->GetNumCoordsPosLevel() ||
+        start.driverInputs.size() != (size_t)sim.GetNumVehicles()) {
+        result.error = "snapshot does not match the worker configuration";
+        return result;
+    }
+    if (candidate.vehicle < 0 || candidate.vehicle >= sim.GetNumVehicles()) {
+        result.error = "no vehicle " + std::to_string(candidate.vehicle);
+        return result;
+    }
+
+    // Vehicles without a candidate keep the inputs they had in the live run
+    sim.RestoreSnapshot(start);
+
+    double step = sim.GetStepSize();
+    double next_sample = start.vehicle.time;
+    auto sample = [&]() {
+        double time = sim.GetSystem()->GetChTime();
+        if (time + 0.5 * step >= next_sample) {
+            result.trajectory.push_back(sim.GetVehicleState(candidate.vehicle));
+            result.sampleTimes.push_back(time);
+            next_sample += candidate.sampleInterval;
+        }
+        result.maxSinkage = std::max(result.maxSinkage, sim.GetMaxSinkage());
+    };
+
+    sample();
+    for (const auto& segment : candidate.segments) {
+        sim.SetInputs(candidate.vehicle, segment.throttle, segment.steering, segment.braking);
+        int steps = (int)std::lround(segment.duration / step);
+        for (int i = 0; i < steps; i++) {
+            sim.Advance(1);
+            sample();
+        }
+    }
+
+    result.finalState = sim.GetVehicleState(candidate.vehicle);
+    result.finalTime = sim.GetSystem()->GetChTime();
+    result.ok = true;
+    result.wallTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+    return result;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "main.h"
+#include "worker_pool.hpp"
+
+// What-if rollouts for planners. The service keeps N worker simulations built once with the
+// live configuration (headless, inputs set in-process). A request carries a snapshot of the
+// live run and a set of candidate control sequences; each candidate is restored into a free
+// worker and simulated as fast as possible, candidates in parallel. The live simulation only
+// pays for taking the snapshot.
+class RolloutService {
+public:
+    struct Settings {
+        int workers;  // Worker simulations, also the number of parallel rollouts
+
+        Settings();
+    };
+
+    // Piecewise-constant inputs for one vehicle
+    struct Segment {
+        double duration;  // (s)
+        double throttle;
+        double steering;
+        double braking;
+    };
+
+    struct Candidate {
+        int vehicle = 0;                // Vehicle index the controls apply to; the others keep their inputs
+        std::vector<Segment> segments;
+        double sampleInterval = 0.1;    // Sim time between trajectory samples (s); per request, so
+                                        // changing it does not rebuild the workers
+    };
+
+    struct Result {
+        bool ok = false;
+        std::string error;
+        std::vector<VehicleState> trajectory;  // Controlled vehicle, every Candidate::sampleInterval, start included
+        std::vector<double> sampleTimes;       // Sim time of each trajectory sample (s)
+        VehicleState finalState;
+        double finalTime = 0;
+        double maxSinkage = 0;                 // Deepest wheel sinkage of any vehicle during the rollout (m)
+        double wallTime = 0;                   // (s)
+    };
+
+    RolloutService(const ChronoSimulation::Config& config, const Settings& settings = Settings());
+    ~RolloutService();
+
+    // Queue candidates to run from a snapshot of a simulation built with the same configuration.
+    // Returns immediately; the future holds one result per candidate, in order.
+    std::future<std::vector<Result>> Submit(std::shared_ptr<const SimulationSnapshot> start,
+                                            const std::vector<Candidate>& candidates);
+
+    // Run candidates on the calling thread's behalf and wait for the results
+    std::vector<Result> Evaluate(std::shared_ptr<const SimulationSnapshot> start,
+                                 const std::vector<Candidate>& candidates);
+
+private:
+    struct Job {
+        std::shared_ptr<const SimulationSnapshot> start;
+        std::vector<Candidate> candidates;
+        std::promise<std::vector<Result>> promise;
+    };
+
+    void DispatchLoop();
+    Result Rollout(ChronoSimulation& sim, const SimulationSnapshot& start, const Candidate& candidate) const;
+
+    Settings settings_;
+    std::vector<std::unique_ptr<ChronoSimulation>> sims_;
+    std::unique_ptr<WorkerPool> pool_;
+
+    // Worker simulations not currently running a candidate
+    std::mutex free_mutex_;
+    std::vector<ChronoSimulation*> free_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::unique_ptr<Job>> jobs_;
+    std::thread dispatcher_;
+    bool stop_;
+};
@@ -1,4 +1,5 @@
 #include "ros_bridge.hpp"
+#include "thread_budget.hpp"
 
 ROSBridge::ROSBridge() : connected_(false) {
     client_.clear_access_channels(websocketpp::log::alevel::all);
@@ -30,6 +31,7 @@ bool ROSBridge::connect(const std::string& uri) {
 
     client_.connect(con);
     client_thread_ = std::thread([this]() {
+        ThreadBudget::PinCurrentThread(ThreadBudget::Role::IO);
         std::cout << "WebSocket thread starting" << std::endl;
         client_.run();
         std::cout << "WebSocket thread ending" << std::endl;
@@ -54,8 +54,10 @@ struct PIDController {
 
 class ROSDriver : public ChDriver {
 public:
-    ROSDriver(ChVehicle& vehicle, double max_speed = 20.0, double max_steering = 0.5) 
+    ROSDriver(ChVehicle& vehicle, double max_speed = 20.0, double max_steering = 0.5,
+              const std::string& ns = "/robot0")
         : ChDriver(vehicle), 
+          cmd_vel_topic_(ns + "/cmd_vel"),
           max_speed_(max_speed), 
           max_steering_(max_steering),
           m_step_size(1.0/100.0),  // Add this: default 100Hz simulation
@@ -106,15 +108,15 @@ public:
         std::cout << "Connected to ROS Bridge" << std::endl;  
         
         // Subscribe to cmd_vel topic
-        if (!ros_bridge_.subscribe("/robot0/cmd_vel", "geometry_msgs/Twist",
+        if (!ros_bridge_.subscribe(cmd_vel_topic_, "geometry_msgs/Twist",
             [this](const json& msg) {
                 std::lock_guard<std::mutex> lock(mutex_);
                 target_linear_vel_ = msg["linear"]["x"].get<double>();
                 target_angular_vel_ = msg["angular"]["z"].get<double>();
             })) {
-            std::cerr << "Failed to subscribe to /robot0/cmd_vel" << std::endl;
+            std::cerr << "Failed to subscribe to " << cmd_vel_topic_ << std::endl;
         } else {
-            std::cout << "Successfully subscribed to /robot0/cmd_vel" << std::endl;
+            std::cout << "Successfully subscribed to " << cmd_vel_topic_ << std::endl;
         }
     }
 
@@ -131,9 +133,13 @@ public:
         double current_speed = vel.Length();
         double current_heading = chassis->GetRot().GetCardanAnglesXYZ().z();
         
-        // Calculate desired heading from angular velocity
-        static double desired_heading = current_heading;
-        desired_heading += target_angular_vel_ * m_step_size;
+        // Calculate desired heading from angular velocity (per driver, not shared between vehicles)
+        if (!heading_initialized_) {
+            desired_heading_ = current_heading;
+            heading_initialized_ = true;
+        }
+        desired_heading_ += target_angular_vel_ * m_step_size;
+        double desired_heading = desired_heading_;
 
         // Special handling for zero linear velocity command
         if (std::abs(target_linear_vel_) < 1e-3) {  // Small threshold for zero
@@ -181,6 +187,7 @@ public:
     double GetCurrentBraking() const { return m_braking; }
 
 private:
+    std::string cmd_vel_topic_;
     ROSBridge ros_bridge_;
     std::mutex mutex_;
     double max_speed_;    // Maximum speed in m/s
@@ -198,6 +205,10 @@ private:
     PIDController speed_controller;
     PIDController steering_controller;
     
+    // Heading integrated from the commanded yaw rate
+    double desired_heading_ = 0;
+    bool heading_initialized_ = false;
+
     // Debug timing
     double last_debug_time_ = 0;
 };
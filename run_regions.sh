@@ -0,0 +1,38 @@
+#!/bin/bash
+# Run the world split into N regions as N local processes talking over loopback UDP.
+#
+# Usage: ./run_regions.sh N [options for every region...]
+#   e.g. ./run_regions.sh 4 --no-viz --no-ros --no-tcp --free-run --duration 60 --vehicles 8 --spawn-pool 8
+#
+# Region k logs to region_k.log and serves its client on TCP port 17863 + k. Every region builds
+# the whole fleet but only starts the vehicles whose start position lies in its strip, so unit
+# ids and /robot<i> namespaces are the same in every region and follow a vehicle across borders.
+# Set MAIN to the executable (default: ./build/main).
+set -e
+
+if [ $# -lt 1 ]; then
+    echo "Usage: $0 N [options...]"
+    exit 1
+fi
+
+REGIONS=$1
+shift
+MAIN=${MAIN:-./build/main}
+
+pids=()
+cleanup() {
+    kill "${pids[@]}" 2>/dev/null || true
+}
+trap cleanup INT TERM
+
+for ((k = 0; k < REGIONS; k++)); do
+    "$MAIN" --regions "$REGIONS" --region "$k" --tcp-port $((17863 + k)) "$@" > "region_$k.log" 2>&1 &
+    pids+=($!)
+    echo "Region $k: pid ${pids[-1]}, log region_$k.log"
+done
+
+status=0
+for pid in "${pids[@]}"; do
+    wait "$pid" || status=1
+done
+exit $status
@@ -1,19 +1,31 @@
 
 #include "simulation_launcher.h"
+#include "thread_budget.hpp"
+
+#include <iostream>
 
 SimulationLauncher::SimulationLauncher(const ChronoSimulation::Config& config)
-    : m_config(config), m_simulation(config) {
+    : m_config(config), m_simulation(config), m_failed(false) {
 }
 
 void SimulationLauncher::Launch() {
-    m_thread = std::thread(&SimulationLauncher::RunSimulation, m_simulation);
+    // The simulation owns threads and atomics, so it runs in place rather than as a copy
+    m_thread = std::thread(&SimulationLauncher::RunSimulation, this);
 }
 
-void SimulationLauncher::Join() {
+bool SimulationLauncher::Join() {
     m_thread.join();
+    return !m_failed;
 }
 
-void SimulationLauncher::RunSimulation(ChronoSimulation simulation) {
-    simulation.Initialize();
-    simulation.Run();
+void SimulationLauncher::RunSimulation() {
+    // Pin before Initialize so Chrono's pools and helper threads inherit the physics core set
+    ThreadBudget::PinCurrentThread(ThreadBudget::Role::PHYSICS);
+    try {
+        m_simulation.Initialize();
+        m_simulation.Run();
+    } catch (const std::exception& e) {
+        std::cerr << "Simulation failed: " << e.what() << std::endl;
+        m_failed = true;
+    }
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 #ifndef SIMULATION_LAUNCHER_H
 #define SIMULATION_LAUNCHER_H
 
+#include <functional>
 #include <thread>
 #include "main.h"
 
@@ -10,14 +11,17 @@ public:
     SimulationLauncher(const ChronoSimulation::Config& config = ChronoSimulation::Config());
     
     void Launch();
-    void Join();
+
+    // Wait for the simulation to end; false if it failed
+    bool Join();
 
 private:
     ChronoSimulation::Config m_config;
     ChronoSimulation m_simulation;
     std::thread m_thread;
+    bool m_failed;
 
-    static void RunSimulation(ChronoSimulation simulation);
+    void RunSimulation();
 };
 
 #endif
\ No newline at end of file
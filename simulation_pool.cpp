@@ -0,0 +1,126 @@
+#include "simulation_pool.hpp"
+
+#include <chrono>
+#include <iostream>
+
+#include "thread_budget.hpp"
+
+namespace {
+const double kRetryDelay = 5.0;  // Wall time before a failed build is retried (s)
+}  // namespace
+
+SimulationPool::Settings::Settings() : size(2), basePort(17900), portCount(8) {}
+
+SimulationPool::SimulationPool(const ChronoSimulation::Config& config, const Settings& settings)
+    : config_(config), settings_(settings), stop_(false) {
+    builder_ = std::thread(&SimulationPool::BuilderLoop, this);
+}
+
+SimulationPool::~SimulationPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    builder_.join();
+}
+
+std::unique_ptr<ChronoSimulation> SimulationPool::TryAcquire() {
+    std::unique_ptr<ChronoSimulation> simulation;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (ready_.empty()) {
+            return nullptr;
+        }
+        simulation = std::move(ready_.front());
+        ready_.pop_front();
+    }
+    // Start on the replacement
+    cv_.notify_all();
+    return simulation;
+}
+
+int SimulationPool::ReservePort() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return AllocatePortLocked();
+}
+
+std::unique_ptr<ChronoSimulation> SimulationPool::Build(int port) const {
+    ChronoSimulation::Config config = config_;
+    config.tcpPort = port;
+    config.rosPrefix = GetRosPrefix(config_.rosPrefix, port);
+    auto simulation = std::make_unique<ChronoSimulation>(config);
+    simulation->Initialize();
+    return simulation;
+}
+
+std::string SimulationPool::GetRosPrefix(const std::string& base, int port) {
+    return base + "/sim" + std::to_string(port);
+}
+
+void SimulationPool::ReleasePort(int port) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ports_in_use_.erase(port);
+    }
+    // A spare may have been waiting for a free port
+    cv_.notify_all();
+}
+
+int SimulationPool::GetReadyCount() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return (int)ready_.size();
+}
+
+int SimulationPool::AllocatePortLocked() {
+    for (int port = settings_.basePort; port < settings_.basePort + settings_.portCount; port++) {
+        if (ports_in_use_.insert(port).second) {
+            return port;
+        }
+    }
+    return -1;
+}
+
+void SimulationPool::BuilderLoop() {
+    // Builds take the same core set as the simulations they prepare
+    ThreadBudget::PinCurrentThread(ThreadBudget::Role::PHYSICS);
+
+    while (true) {
+        int port;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] {
+                return stop_ || ((int)ready_.size() < settings_.size &&
+                                 (int)ports_in_use_.size() < settings_.portCount);
+            });
+            if (stop_) return;
+            port = AllocatePortLocked();
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        std::unique_ptr<ChronoSimulation> simulation;
+        try {
+            simulation = Build(port);
+        } catch (const std::exception& e) {
+            // E.g. the port is taken by another process: give it back and retry after a pause,
+            // so a persistent failure neither spins nor takes the server down
+            std::cerr << "Warm pool: building a simulation on port " << port << " failed: " << e.what()
+                      << std::endl;
+            std::unique_lock<std::mutex> lock(mutex_);
+            ports_in_use_.erase(port);
+            cv_.wait_for(lock, std::chrono::duration<double>(kRetryDelay), [this] { return stop_; });
+            if (stop_) return;
+            continue;
+        }
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stop_) {
+            ports_in_use_.erase(port);
+            return;
+        }
+        ready_.push_back(std::move(simulation));
+        std::cout << "Warm pool: simulation on port " << port << " ready after " << elapsed << " s ("
+                  << ready_.size() << "/" << settings_.size << ")" << std::endl;
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+
+#include "main.h"
+
+// Warm pool of simulations for one configuration. A builder thread keeps `size` simulations
+// through Initialize() (vehicles, terrain, ROS connections, TCP listen socket), so handing
+// one out costs nothing and its replacement is built in the background. Every pooled
+// simulation listens on its own client port from [basePort, basePort + portCount) and
+// publishes ROS topics under GetRosPrefix() of that port.
+class SimulationPool {
+public:
+    struct Settings {
+        int size;       // Initialized simulations kept ready
+        int basePort;   // First client port of pooled simulations
+        int portCount;  // Ports shared by ready and running pooled simulations
+
+        Settings();
+    };
+
+    SimulationPool(const ChronoSimulation::Config& config, const Settings& settings);
+    ~SimulationPool();
+
+    // A ready simulation, or nullptr when none has finished initializing yet
+    std::unique_ptr<ChronoSimulation> TryAcquire();
+
+    // Reserve a client port for a simulation built with Build(); -1 when all are in use
+    int ReservePort();
+
+    // Initialize a simulation with the pool configuration on the calling thread; throws like
+    // ChronoSimulation::Initialize(). The builder thread logs failures and retries later.
+    std::unique_ptr<ChronoSimulation> Build(int port) const;
+
+    // ROS prefix of the simulation on client port `port`: <base>/sim<port>
+    static std::string GetRosPrefix(const std::string& base, int port);
+
+    // Give back the port of a pooled simulation that has ended or was dropped
+    void ReleasePort(int port);
+
+    int GetReadyCount();
+
+private:
+    void BuilderLoop();
+    int AllocatePortLocked();
+
+    ChronoSimulation::Config config_;
+    Settings settings_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::unique_ptr<ChronoSimulation>> ready_;
+    std::set<int> ports_in_use_;
+    std::thread builder_;
+    bool stop_;
+};
@@ -0,0 +1,392 @@
+#include "simulation_server.hpp"
+
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#include "thread_budget.hpp"
+
+namespace {
+// A control client sending more than this without a newline is dropped
+const size_t kMaxCommandLength = 64 * 1024;
+}  // namespace
+
+SimulationServer::Settings::Settings() : port(0), maxSessions(4), warmPool(0) {}
+
+SimulationServer::SimulationServer(const ChronoSimulation::Config& defaults, const ConfigParser& parser,
+                                   const Settings& settings)
+    : defaults_(defaults), parser_(parser), settings_(settings), pool_port_count_(0), next_id_(1), shutdown_(false) {
+    // Pooled sessions take ports from tcpPort on: one per ready spare and one per running session.
+    // Other sessions allocate from the end of that range, so the two never collide.
+    if (settings_.warmPool > 0) {
+        SimulationPool::Settings pool_settings;
+        pool_settings.size = settings_.warmPool;
+        pool_settings.basePort = defaults_.tcpPort;
+        pool_settings.portCount = settings_.warmPool + std::max(settings_.maxSessions, 1);
+        pool_port_count_ = pool_settings.portCount;
+        pool_ = std::make_unique<SimulationPool>(defaults_, pool_settings);
+    }
+    for (int i = 0; i < std::max(settings_.maxSessions, 1); i++) {
+        workers_.emplace_back(&SimulationServer::WorkerLoop, this);
+    }
+}
+
+SimulationServer::~SimulationServer() {
+    StopAll();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+    sessions_.clear();
+    pool_.reset();
+}
+
+void SimulationServer::Run() {
+    int server_socket = socket(AF_INET, SOCK_STREAM, 0);
+    if (server_socket < 0) {
+        throw std::runtime_error(std::string("Failed to create control socket: ") + strerror(errno));
+    }
+    int opt = 1;
+    setsockopt(server_socket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+    // Control is local only; sessions open their own client ports
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(settings_.port);
+    if (bind(server_socket, (sockaddr*)&address, sizeof(address)) < 0 || listen(server_socket, 4) < 0) {
+        std::string error = "Failed to listen on control port " + std::to_string(settings_.port) + ": " + strerror(errno);
+        close(server_socket);
+        throw std::runtime_error(error);
+    }
+    std::cout << "Simulation server listening on 127.0.0.1:" << settings_.port << " (" << workers_.size()
+              << " session slots, warm pool of " << settings_.warmPool << ")" << std::endl;
+
+    // Control clients are polled together, so an idle one cannot hold up the others
+    std::vector<ControlClient> clients;
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (shutdown_) break;
+        }
+        std::vector<pollfd> fds{{server_socket, POLLIN, 0}};
+        for (const auto& client : clients) {
+            fds.push_back({client.socket, POLLIN, 0});
+        }
+        if (poll(fds.data(), fds.size(), 200) <= 0) continue;
+
+        for (size_t i = clients.size(); i-- > 0;) {
+            if (fds[i + 1].revents != 0 && !ServeClient(clients[i])) {
+                close(clients[i].socket);
+                clients.erase(clients.begin() + i);
+            }
+        }
+        if (fds[0].revents & POLLIN) {
+            int client_socket = accept(server_socket, nullptr, nullptr);
+            if (client_socket >= 0) {
+                clients.push_back({client_socket, ""});
+            }
+        }
+    }
+    for (const auto& client : clients) {
+        close(client.socket);
+    }
+    close(server_socket);
+
+    StopAll();
+    std::cout << "Simulation server stopped" << std::endl;
+}
+
+bool SimulationServer::ServeClient(ControlClient& client) {
+    // Called when poll() reports the socket readable, so this recv does not block
+    char chunk[1024];
+    ssize_t n = recv(client.socket, chunk, sizeof(chunk), 0);
+    if (n <= 0) return false;
+    client.buffer.append(chunk, n);
+
+    size_t end;
+    while ((end = client.buffer.find('\n')) != std::string::npos) {
+        std::string line = client.buffer.substr(0, end);
+        client.buffer.erase(0, end + 1);
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty()) continue;
+
+        // Replies are short; a client that lets its receive buffer fill up is dropped
+        std::string reply = HandleCommand(line) + "\n";
+        if (send(client.socket, reply.data(), reply.size(), MSG_NOSIGNAL | MSG_DONTWAIT) != (ssize_t)reply.size()) {
+            return false;
+        }
+    }
+    return client.buffer.size() <= kMaxCommandLength;
+}
+
+std::string SimulationServer::HandleCommand(const std::string& line) {
+    std::istringstream stream(line);
+    std::string command;
+    stream >> command;
+    std::string rest;
+    std::getline(stream >> std::ws, rest);
+
+    if (command == "create") {
+        return CreateSession(rest);
+    }
+    if (command == "stop") {
+        try {
+            return StopSession(std::stoi(rest));
+        } catch (const std::exception& e) {
+            return "error stop needs a session id";
+        }
+    }
+    if (command == "list") {
+        return ListSessions();
+    }
+    if (command == "shutdown") {
+        StopAll();
+        return "ok";
+    }
+    return "error unknown command '" + command + "'";
+}
+
+std::string SimulationServer::CreateSession(const std::string& args) {
+    std::vector<std::string> tokens;
+    std::istringstream stream(args);
+    std::string token;
+    while (stream >> token) {
+        tokens.push_back(token);
+    }
+
+    auto session = std::make_shared<Session>();
+    session->args = args;
+    session->config = defaults_;
+    session->pooled = pool_ && tokens.empty();
+    session->port = -1;
+    session->state = State::QUEUED;
+    session->stopRequested = false;
+    session->endTime = 0;
+    session->initialized = false;
+
+    std::string error;
+    if (!parser_(tokens, session->config, error)) {
+        return "error " + error;
+    }
+
+    // A warm simulation is claimed right away so the client can connect to its port while
+    // the session waits for a worker; without a spare, the worker builds one on that port
+    if (session->pooled) {
+        session->simulation = pool_->TryAcquire();
+        if (session->simulation) {
+            session->port = session->simulation->GetConfig().tcpPort;
+            session->initialized = true;
+        } else if ((session->port = pool_->ReservePort()) < 0) {
+            return "error no free client port";
+        }
+        session->rosPrefix = SimulationPool::GetRosPrefix(defaults_.rosPrefix, session->port);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!session->pooled) {
+        // Options equal to the server defaults count as not given
+        bool explicit_port = session->config.tcpPort != defaults_.tcpPort;
+        bool explicit_prefix = session->config.rosPrefix != defaults_.rosPrefix;
+        if (explicit_port && IsPoolPort(session->config.tcpPort)) {
+            return "error client port " + std::to_string(session->config.tcpPort) + " belongs to the warm pool";
+        }
+        if (explicit_port && client_ports_.count(session->config.tcpPort)) {
+            return "error client port " + std::to_string(session->config.tcpPort) + " is used by another session";
+        }
+        if (explicit_prefix && ros_prefixes_.count(session->config.rosPrefix)) {
+            return "error ROS prefix " + session->config.rosPrefix + " is used by another session";
+        }
+        session->port = explicit_port ? session->config.tcpPort : AllocateClientPortLocked();
+        if (session->port < 0) {
+            return "error no free client port";
+        }
+        session->rosPrefix = explicit_prefix ? session->config.rosPrefix
+                                             : SimulationPool::GetRosPrefix(defaults_.rosPrefix, session->port);
+        if (ros_prefixes_.count(session->rosPrefix)) {
+            return "error ROS prefix " + session->rosPrefix + " is used by another session";
+        }
+        session->config.tcpPort = session->port;
+        session->config.rosPrefix = session->rosPrefix;
+        client_ports_.insert(session->port);
+        ros_prefixes_.insert(session->rosPrefix);
+    }
+
+    session->id = next_id_++;
+    sessions_[session->id] = session;
+    if (shutdown_) {
+        StopLocked(*session);
+        return "error shutting down";
+    }
+    queue_.push_back(session);
+    queue_cv_.notify_one();
+    std::cout << "Session " << session->id << " queued" << (session->initialized ? " (warm)" : "") << ": "
+              << args << std::endl;
+    return "ok " + std::to_string(session->id) + " port " + std::to_string(session->port) + " ros " +
+           session->rosPrefix;
+}
+
+std::string SimulationServer::StopSession(int id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = sessions_.find(id);
+    if (it == sessions_.end()) {
+        return "error no session " + std::to_string(id);
+    }
+    StopLocked(*it->second);
+    return "ok";
+}
+
+std::string SimulationServer::ListSessions() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::ostringstream out;
+    for (const auto& entry : sessions_) {
+        const Session& session = *entry.second;
+        double time = session.state == State::RUNNING && session.simulation ? session.simulation->GetSimTime()
+                                                                            : session.endTime;
+        out << session.id << " " << StateName(session.state) << " port=" << session.port << " t=" << time << " ";
+        if (session.state == State::FAILED) {
+            out << "error=" << session.error << "; ";
+        }
+        out << session.args << "\n";
+    }
+    out << "end";
+    return out.str();
+}
+
+void SimulationServer::StopAll() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    shutdown_ = true;
+    for (auto& entry : sessions_) {
+        StopLocked(*entry.second);
+    }
+    queue_.clear();
+    queue_cv_.notify_all();
+}
+
+void SimulationServer::StopLocked(Session& session) {
+    session.stopRequested = true;
+    if (session.state == State::RUNNING) {
+        // A session still being built notices the request once the build is done
+        if (session.simulation) {
+            session.simulation->Stop();
+        }
+    } else if (session.state == State::QUEUED) {
+        // Never started: drop a claimed warm simulation and give its port back
+        session.state = State::STOPPED;
+        session.simulation.reset();
+        ReleaseLocked(session);
+    }
+}
+
+bool SimulationServer::IsPoolPort(int port) const {
+    return port >= defaults_.tcpPort && port < defaults_.tcpPort + pool_port_count_;
+}
+
+int SimulationServer::AllocateClientPortLocked() {
+    for (int port = defaults_.tcpPort + pool_port_count_; port <= 65535; port++) {
+        if (!client_ports_.count(port)) {
+            return port;
+        }
+    }
+    return -1;
+}
+
+void SimulationServer::ReleaseLocked(Session& session) {
+    if (session.pooled) {
+        pool_->ReleasePort(session.port);
+    } else {
+        client_ports_.erase(session.port);
+        ros_prefixes_.erase(session.rosPrefix);
+    }
+}
+
+void SimulationServer::WorkerLoop() {
+    while (true) {
+        std::shared_ptr<Session> session;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            queue_cv_.wait(lock, [this] { return shutdown_ || !queue_.empty(); });
+            if (queue_.empty()) return;
+            session = queue_.front();
+            queue_.pop_front();
+            if (session->stopRequested) continue;
+            session->state = State::RUNNING;
+            if (!session->simulation && !session->pooled) {
+                session->simulation = std::make_unique<ChronoSimulation>(session->config);
+            }
+        }
+        RunSession(*session);
+    }
+}
+
+void SimulationServer::RunSession(Session& session) {
+    // Same setup as SimulationLauncher, on a pooled thread
+    ThreadBudget::PinCurrentThread(ThreadBudget::Role::PHYSICS);
+    std::cout << "Session " << session.id << " started" << std::endl;
+    std::string error;
+    try {
+        if (session.pooled && !session.simulation) {
+            // The pool had no spare at create time; build one on the reserved port
+            auto simulation = pool_->Build(session.port);
+            std::lock_guard<std::mutex> lock(mutex_);
+            session.simulation = std::move(simulation);
+            if (session.stopRequested) {
+                session.simulation->Stop();
+            }
+        } else if (!session.initialized) {
+            session.simulation->Initialize();
+        }
+        session.simulation->Run();
+    } catch (const std::exception& e) {
+        // Only this session fails; the server and the other sessions keep running
+        error = e.what();
+    }
+
+    // Free the vehicles and the SCM mesh right away; the entry stays for list
+    std::unique_ptr<ChronoSimulation> finished;
+    State state;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        session.endTime = session.simulation ? session.simulation->GetSimTime() : 0;
+        if (!error.empty()) {
+            session.state = state = State::FAILED;
+            session.error = error;
+        } else {
+            session.state = state = session.stopRequested ? State::STOPPED : State::FINISHED;
+        }
+        finished = std::move(session.simulation);
+    }
+    // The port is given back only once the simulation has closed its listen socket
+    finished.reset();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ReleaseLocked(session);
+    }
+    if (state == State::FAILED) {
+        std::cerr << "Session " << session.id << " failed at t=" << session.endTime << ": " << error << std::endl;
+    } else {
+        std::cout << "Session " << session.id << " " << StateName(state) << " at t=" << session.endTime << std::endl;
+    }
+}
+
+const char* SimulationServer::StateName(State state) {
+    switch (state) {
+        case State::QUEUED:
+            return "queued";
+        case State::RUNNING:
+            return "running";
+        case State::FINISHED:
+            return "finished";
+        case State::STOPPED:
+            return "stopped";
+        case State::FAILED:
+            return "failed";
+    }
+    return "unknown";
+}
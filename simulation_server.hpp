@@ -0,0 +1,109 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "main.h"
+#include "simulation_pool.hpp"
+
+// Long-running host for many simulation sessions in one process. Sessions run on a fixed
+// set of worker threads (queued when all are busy) and share heightmap measurements through
+// TerrainSource. Sessions without options come from a warm pool of initialized simulations
+// when one is configured. Every session gets its own client port and ROS prefix: a --tcp-port
+// or --ros-prefix already taken by another session is rejected, and without them the session
+// gets a free port and the prefix <default prefix>/sim<port>. The warm pool owns the client
+// ports [tcpPort, tcpPort + warmPool + maxSessions); other sessions use ports above them.
+// A session whose setup or run throws ends as failed without affecting the others.
+// Clients drive the server over a line-based control socket on localhost, any number at once:
+//
+//   create <args>  start a session; args are command line options applied on top of the
+//                  server defaults. Replies "ok <id> port <client port> ros <prefix>" or
+//                  "error <reason>".
+//   stop <id>      ask a session to finish (or drop it from the queue). Replies "ok".
+//   list           one line per session, "<id> <state> port=<p> t=<sim time> [error=<reason>;] <args>",
+//                  then "end".
+//   shutdown       stop every session and exit the server.
+class SimulationServer {
+public:
+    // Applies session arguments to a config; returns false with a message if they are invalid
+    using ConfigParser = std::function<bool(const std::vector<std::string>& args,
+                                            ChronoSimulation::Config& config, std::string& error)>;
+
+    struct Settings {
+        int port;         // Control socket port, 0 = no server (single simulation)
+        int maxSessions;  // Sessions running at the same time, further ones wait in the queue
+        int warmPool;     // Initialized default sessions kept ready, 0 = build every session on demand
+
+        Settings();
+    };
+
+    SimulationServer(const ChronoSimulation::Config& defaults, const ConfigParser& parser,
+                     const Settings& settings);
+    ~SimulationServer();
+
+    // Serve the control socket until a shutdown command, then stop and join every session.
+    // Throws std::runtime_error if the control port cannot be bound.
+    void Run();
+
+private:
+    enum class State { QUEUED, RUNNING, FINISHED, STOPPED, FAILED };
+
+    struct Session {
+        int id;
+        std::string args;
+        ChronoSimulation::Config config;
+        bool pooled;                                   // Default session; port belongs to the warm pool
+        int port;                                      // Client port
+        std::string rosPrefix;
+        State state;
+        bool stopRequested;
+        double endTime;                                // Sim time when the session ended
+        std::unique_ptr<ChronoSimulation> simulation;  // Set once taken from the pool or started
+        bool initialized;                              // simulation came out of the pool initialized
+        std::string error;                             // Why a FAILED session failed
+    };
+
+    struct ControlClient {
+        int socket;
+        std::string buffer;  // Received bytes not yet forming a complete line
+    };
+
+    void WorkerLoop();
+    void RunSession(Session& session);
+    bool ServeClient(ControlClient& client);
+    std::string HandleCommand(const std::string& line);
+    std::string CreateSession(const std::string& args);
+    std::string StopSession(int id);
+    std::string ListSessions();
+    void StopAll();
+    void StopLocked(Session& session);
+    bool IsPoolPort(int port) const;
+    int AllocateClientPortLocked();
+    void ReleaseLocked(Session& session);
+
+    static const char* StateName(State state);
+
+    ChronoSimulation::Config defaults_;
+    ConfigParser parser_;
+    Settings settings_;
+    std::unique_ptr<SimulationPool> pool_;
+    int pool_port_count_;  // Client ports from defaults_.tcpPort on reserved for the pool
+
+    std::mutex mutex_;
+    std::condition_variable queue_cv_;
+    std::map<int, std::shared_ptr<Session>> sessions_;
+    std::deque<std::shared_ptr<Session>> queue_;
+    std::set<int> client_ports_;          // Client ports of sessions outside the warm pool
+    std::set<std::string> ros_prefixes_;  // ROS prefixes of sessions outside the warm pool
+    std::vector<std::thread> workers_;
+    int next_id_;
+    bool shutdown_;
+};
@@ -0,0 +1,19 @@
+#include "simulation_snapshot.hpp"
+
+using namespace chrono;
+
+void SystemState::Capture(ChSystem& system) {
+    // Make sure the state counts reflect the current set of bodies and links
+    system.Setup();
+
+    x = ChState(system.GetNumCoordsPosLevel(), &system);
+    v = ChStateDelta(system.GetNumCoordsVelLevel(), &system);
+    a = ChStateDelta(system.GetNumCoordsVelLevel(), &system);
+    system.StateGather(x, v, time);
+    system.StateGatherAcceleration(a);
+}
+
+void SystemState::Restore(ChSystem& system) const {
+    system.StateScatter(x, v, time, true);
+    system.StateScatterAcceleration(a);
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "chrono/physics/ChSystem.h"
+#include "chrono_vehicle/ChDriver.h"
+#include "chrono_vehicle/terrain/SCMTerrain.h"
+#include "terrain_coupling.hpp"
+
+// Full kinematic state of a ChSystem: positions, velocities, accelerations and time.
+// Restoring is only valid into the same system, or one built the same way (same bodies, links
+// and shafts in the same order).
+struct SystemState {
+    double time = 0;
+    chrono::ChState x;
+    chrono::ChStateDelta v;
+    chrono::ChStateDelta a;
+
+    void Capture(chrono::ChSystem& system);
+    void Restore(chrono::ChSystem& system) const;
+};
+
+// In-memory copy of everything a ChronoSimulation needs to continue from a given step
+struct SimulationSnapshot {
+    SystemState vehicle;                     // Vehicle system (also holds SCM unless explicitly coupled)
+    SystemState coupling;                    // Terrain system in explicit coupling mode
+    std::vector<TerrainCoupling::WheelForce> couplingForces;  // Lagged forces for the next step
+    std::vector<chrono::vehicle::SCMTerrain::NodeLevel> terrainNodes;  // Every node deformed so far
+    std::vector<chrono::vehicle::DriverInputs> driverInputs;  // One per vehicle unit
+    std::vector<int> unitIds;                 // Unit id per vehicle, -1 for parked pool vehicles
+    uint64_t stepCount = 0;
+    double stepSize = 0;
+};
@@ -0,0 +1,82 @@
+#include "stability_watchdog.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+StabilityWatchdog::Settings::Settings()
+    : checkpointInterval(0.5),
+      checkpointCount(4),
+      maxLinearSpeed(60.0),
+      maxAngularSpeed(30.0),
+      maxAcceleration(500.0),
+      maxSolverResidual(1.0),
+      maxSinkage(0.5),
+      stepReduction(0.5),
+      minStepSize(1e-4),
+      recoveryTime(2.0) {}
+
+StabilityWatchdog::StabilityWatchdog(const Settings& settings)
+    : settings_(settings), next_checkpoint_(0), reduced_(false), recover_time_(0), rollbacks_(0) {}
+
+static bool IsFinite(const chrono::ChVector3d& v) {
+    return std::isfinite(v.x()) && std::isfinite(v.y()) && std::isfinite(v.z());
+}
+
+std::string StabilityWatchdog::Check(const Sample& sample) const {
+    const VehicleState& s = sample.chassis;
+    std::ostringstream reason;
+
+    if (!IsFinite(s.pos) || !IsFinite(s.vel) || !IsFinite(s.acc) ||
+        !std::isfinite(s.rot.e0()) || !std::isfinite(s.rot.e1()) ||
+        !std::isfinite(s.rot.e2()) || !std::isfinite(s.rot.e3())) {
+        reason << "non-finite chassis state";
+    } else if (std::abs(s.rot.Length() - 1.0) > 1e-3) {
+        reason << "denormalized chassis rotation (|q|=" << s.rot.Length() << ")";
+    } else if (s.vel.Length() > settings_.maxLinearSpeed) {
+        reason << "chassis speed " << s.vel.Length() << " m/s";
+    } else if (s.acc.Length() > settings_.maxAcceleration) {
+        reason << "chassis acceleration " << s.acc.Length() << " m/s^2";
+    } else if (2 * s.rotDt.Length() > settings_.maxAngularSpeed) {
+        // |dq/dt| = |w| / 2 for a unit quaternion
+        reason << "chassis angular speed " << 2 * s.rotDt.Length() << " rad/s";
+    } else if (!std::isfinite(sample.solverResidual) || sample.solverResidual > settings_.maxSolverResidual) {
+        reason << "solver residual " << sample.solverResidual;
+    } else if (!std::isfinite(sample.maxSinkage) || sample.maxSinkage > settings_.maxSinkage) {
+        reason << "wheel sinkage " << sample.maxSinkage << " m";
+    }
+
+    return reason.str();
+}
+
+void StabilityWatchdog::AddCheckpoint(std::shared_ptr<SimulationSnapshot> snapshot) {
+    checkpoints_.push_back(snapshot);
+    while ((int)checkpoints_.size() > settings_.checkpointCount) {
+        checkpoints_.pop_front();
+    }
+    next_checkpoint_ = snapshot->vehicle.time + settings_.checkpointInterval;
+}
+
+std::shared_ptr<SimulationSnapshot> StabilityWatchdog::Rollback(double current_step, double& retry_step) {
+    if (checkpoints_.empty()) {
+        return nullptr;
+    }
+
+    if (current_step <= settings_.minStepSize) {
+        // Already failed at the smallest step from this checkpoint: fall back to an older one
+        checkpoints_.pop_back();
+        if (checkpoints_.empty()) {
+            return nullptr;
+        }
+    }
+
+    rollbacks_++;
+    retry_step = std::max(current_step * settings_.stepReduction, settings_.minStepSize);
+
+    auto target = checkpoints_.back();
+    // No new checkpoint until the retry has made it past the failure point
+    next_checkpoint_ = target->vehicle.time + settings_.checkpointInterval;
+    reduced_ = true;
+    recover_time_ = target->vehicle.time + settings_.recoveryTime;
+    return target;
+}
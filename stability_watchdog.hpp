@@ -0,0 +1,65 @@
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <string>
+
+#include "state_bus.hpp"
+#include "simulation_snapshot.hpp"
+
+// Detects numerical blow-ups and manages the rolling checkpoints used to recover from them.
+// Every step the simulation hands in a Sample; a healthy step may be turned into a new
+// checkpoint, a diverged one is answered with the checkpoint to roll back to and the
+// reduced step size to retry with.
+class StabilityWatchdog {
+public:
+    struct Settings {
+        double checkpointInterval;  // Sim time (s) between rolling checkpoints
+        int checkpointCount;        // Checkpoints kept; older ones are dropped
+        double maxLinearSpeed;      // Chassis speed (m/s) treated as divergence
+        double maxAngularSpeed;     // Chassis angular speed (rad/s) treated as divergence
+        double maxAcceleration;     // Chassis acceleration (m/s^2) treated as divergence
+        double maxSolverResidual;   // Solver residual treated as divergence
+        double maxSinkage;          // Wheel depth (m) below the undeformed SCM surface
+        double stepReduction;       // Step multiplier applied on every rollback
+        double minStepSize;         // Retries never go below this step
+        double recoveryTime;        // Sim time (s) at the reduced step before returning to nominal
+
+        Settings();
+    };
+
+    struct Sample {
+        double time;
+        VehicleState chassis;
+        double solverResidual;
+        double maxSinkage;
+    };
+
+    StabilityWatchdog(const Settings& settings = Settings());
+
+    // Returns an empty string for a healthy step, otherwise what diverged
+    std::string Check(const Sample& sample) const;
+
+    // True when a healthy step at this time should be saved as a checkpoint
+    bool CheckpointDue(double time) const { return time >= next_checkpoint_; }
+    void AddCheckpoint(std::shared_ptr<SimulationSnapshot> snapshot);
+
+    // After a divergence: the checkpoint to restore and the step to retry with. Repeated
+    // failures keep reducing the step; a failure at the minimum step drops the newest
+    // checkpoint in favour of an older one. Returns nullptr when no checkpoint is left.
+    std::shared_ptr<SimulationSnapshot> Rollback(double current_step, double& retry_step);
+
+    // True once the run has been stable at the reduced step for recoveryTime
+    bool Recovered(double time) const { return reduced_ && time >= recover_time_; }
+    void ClearRecovery() { reduced_ = false; }
+
+    int GetRollbacks() const { return rollbacks_; }
+
+private:
+    Settings settings_;
+    std::deque<std::shared_ptr<SimulationSnapshot>> checkpoints_;
+    double next_checkpoint_;
+    bool reduced_;
+    double recover_time_;
+    int rollbacks_;
+};
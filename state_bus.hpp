@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "chrono/core/ChVector3.h"
+#include "chrono/core/ChQuaternion.h"
+
+// Chassis state captured by the physics thread at the end of a step
+struct VehicleState {
+    chrono::ChVector3d pos;
+    chrono::ChQuaternion<> rot;
+    chrono::ChVector3d vel;         // Linear velocity (GetPosDt)
+    chrono::ChVector3d acc;         // Linear acceleration (GetPosDt2)
+    chrono::ChQuaternion<> rotDt;   // Quaternion derivative (GetRotDt)
+};
+
+// Immutable per-step snapshot handed from the physics thread to its consumers
+struct StateFrame {
+    uint64_t step = 0;
+    double time = 0;
+    std::vector<VehicleState> vehicles;  // Chassis state of every vehicle in unit order, then region ghosts
+    std::vector<int> unitIds;            // Unit id of each vehicle, -1 while it is parked
+};
+
+// Single-producer single-consumer triple buffer. The producer always has a free slot to
+// write, the consumer always reads the most recent complete value, and neither blocks.
+template <class T>
+class TripleBuffer {
+public:
+    // Producer side: copy the value in and make it the latest
+    void Publish(const T& value) {
+        buffers_[back_] = value;
+        back_ = middle_.exchange(back_ | kDirty, std::memory_order_acq_rel) & kIndex;
+    }
+
+    // Consumer side: swap in the latest value if there is a new one
+    bool Update() {
+        if (!(middle_.load(std::memory_order_acquire) & kDirty)) return false;
+        front_ = middle_.exchange(front_, std::memory_order_acq_rel) & kIndex;
+        return true;
+    }
+
+    const T& Front() const { return buffers_[front_]; }
+
+private:
+    static constexpr uint8_t kIndex = 0x3;
+    static constexpr uint8_t kDirty = 0x4;
+
+    T buffers_[3];
+    uint8_t back_ = 0;
+    uint8_t front_ = 2;
+    std::atomic<uint8_t> middle_{1};
+};
+
+// Fans each published StateFrame out to every subscriber through its own triple buffer,
+// so a slow consumer never blocks the physics thread or another consumer. Subscribe
+// before the first Publish; the subscriber list is not guarded.
+class StateBus {
+public:
+    using Reader = TripleBuffer<StateFrame>;
+
+    Reader* Subscribe() {
+        readers_.push_back(std::make_unique<Reader>());
+        return readers_.back().get();
+    }
+
+    void Publish(const StateFrame& frame) {
+        for (auto& reader : readers_) {
+            reader->Publish(frame);
+        }
+    }
+
+private:
+    std::vector<std::unique_ptr<Reader>> readers_;
+};
@@ -0,0 +1,240 @@
+#include "sweep_runner.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <thread>
+
+#include "terrain_source.hpp"
+#include "worker_pool.hpp"
+
+using namespace chrono;
+
+namespace {
+using Config = ChronoSimulation::Config;
+
+const std::map<std::string, double Config::*>& Parameters() {
+    static const std::map<std::string, double Config::*> parameters = {
+        {"soilKphi", &Config::soilKphi},
+        {"soilKc", &Config::soilKc},
+        {"soilN", &Config::soilN},
+        {"soilCohesion", &Config::soilCohesion},
+        {"soilFriction", &Config::soilFriction},
+        {"soilJanosi", &Config::soilJanosi},
+        {"soilStiffness", &Config::soilStiffness},
+        {"soilDamping", &Config::soilDamping},
+        {"stepSize", &Config::stepSize},
+        {"terrainDelta", &Config::terrainDelta},
+    };
+    return parameters;
+}
+}  // namespace
+
+SweepRunner::Settings::Settings() : outputFile("sweep_results.csv"), workers(0) {}
+
+SweepRunner::SweepRunner(const ChronoSimulation::Config& base, const Settings& settings)
+    : base_(base), settings_(settings) {
+    // Headless and unpaced, driven by the scripted maneuver unless a trace is replayed
+    base_.useTcpServer = false;
+    base_.lockstep = false;
+    base_.useRos = false;
+    base_.useVisualization = false;
+    base_.realtimeMode = false;
+    base_.adaptiveStep = false;
+    base_.qosGovernor = false;
+    base_.externalInputs = false;
+    base_.scriptedDriver = true;
+    base_.spawnPoolSize = 0;
+    base_.regionSettings.regions = 1;
+    base_.terrainNode.clear();
+    base_.recordInputsFile.clear();
+    base_.trajectoryFile.clear();
+    if (base_.duration <= 0) {
+        base_.duration = 10.0;
+    }
+}
+
+std::vector<std::string> SweepRunner::GetParameterNames() {
+    std::vector<std::string> names;
+    for (const auto& entry : Parameters()) {
+        names.push_back(entry.first);
+    }
+    return names;
+}
+
+bool SweepRunner::LoadGrid() {
+    std::ifstream file(settings_.gridFile);
+    if (!file) {
+        std::cerr << "Cannot open sweep grid " << settings_.gridFile << std::endl;
+        return false;
+    }
+
+    grid_.clear();
+    std::string line;
+    int line_number = 0;
+    while (std::getline(file, line)) {
+        line_number++;
+        line = line.substr(0, line.find('#'));
+        std::stringstream ss(line);
+        Parameter parameter;
+        if (!(ss >> parameter.name)) continue;
+
+        if (!Parameters().count(parameter.name)) {
+            std::cerr << settings_.gridFile << ":" << line_number << ": unknown parameter " << parameter.name
+                      << ", expected one of:";
+            for (const auto& name : GetParameterNames()) {
+                std::cerr << " " << name;
+            }
+            std::cerr << std::endl;
+            return false;
+        }
+        std::string token;
+        while (ss >> token) {
+            try {
+                parameter.values.push_back(std::stod(token));
+            } catch (const std::exception& e) {
+                std::cerr << settings_.gridFile << ":" << line_number << ": invalid value " << token << std::endl;
+                return false;
+            }
+        }
+        if (parameter.values.empty()) {
+            std::cerr << settings_.gridFile << ":" << line_number << ": no values for " << parameter.name
+                      << std::endl;
+            return false;
+        }
+        grid_.push_back(parameter);
+    }
+
+    if (grid_.empty()) {
+        std::cerr << "Sweep grid " << settings_.gridFile << " has no parameters" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+size_t SweepRunner::GetNumCases() const {
+    size_t cases = grid_.empty() ? 0 : 1;
+    for (const auto& parameter : grid_) {
+        cases *= parameter.values.size();
+    }
+    return cases;
+}
+
+std::vector<double> SweepRunner::CaseValues(size_t index) const {
+    // The last parameter varies fastest
+    std::vector<double> values(grid_.size());
+    for (size_t p = grid_.size(); p-- > 0;) {
+        values[p] = grid_[p].values[index % grid_[p].values.size()];
+        index /= grid_[p].values.size();
+    }
+    return values;
+}
+
+ChronoSimulation::Config SweepRunner::MakeCase(const std::vector<double>& values) const {
+    ChronoSimulation::Config config = base_;
+    for (size_t p = 0; p < grid_.size(); p++) {
+        config.*Parameters().at(grid_[p].name) = values[p];
+    }
+    return config;
+}
+
+bool SweepRunner::Run() {
+    output_.open(settings_.outputFile);
+    if (!output_) {
+        std::cerr << "Cannot open sweep output " << settings_.outputFile << std::endl;
+        return false;
+    }
+    output_ << "case";
+    for (const auto& parameter : grid_) {
+        output_ << "," << parameter.name;
+    }
+    output_ << ",status,sim_time,distance,mean_speed,final_x,final_y,final_z,max_sinkage,final_sinkage,wall_time,rtf"
+            << std::endl;
+    output_ << std::setprecision(10);
+
+    size_t cases = GetNumCases();
+
+    // Measure the heightmap scale for every grid spacing of the grid up front, so the first
+    // cases do not each wait on a throwaway SCM build. The cases still build their own terrain
+    std::set<double> deltas;
+    for (size_t i = 0; i < cases; i++) {
+        deltas.insert(MakeCase(CaseValues(i)).terrainDelta);
+    }
+    for (double delta : deltas) {
+        TerrainSource::Get({base_.heightmapFile, base_.terrainHeight, base_.terrainWidth, base_.terrainZ, delta});
+    }
+
+    int workers = settings_.workers > 0 ? settings_.workers : (int)std::max(1u, std::thread::hardware_concurrency());
+    workers = std::min(workers, (int)cases);
+    std::cout << "Sweep: " << cases << " cases of " << base_.duration << " s on " << workers << " workers -> "
+              << settings_.outputFile << std::endl;
+
+    auto start = std::chrono::steady_clock::now();
+    WorkerPool pool(workers);
+    pool.ParallelFor(0, (int)cases, [&](int i) {
+        std::vector<double> values = CaseValues(i);
+        Metrics metrics;
+        try {
+            metrics = RunCase(MakeCase(values));
+        } catch (const std::exception& e) {
+            std::cerr << "Sweep: case " << i << " failed: " << e.what() << std::endl;
+            metrics.status = "error";
+        }
+        WriteRow(i, values, metrics);
+    });
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Sweep: " << cases << " cases done in " << elapsed << " s" << std::endl;
+    return true;
+}
+
+SweepRunner::Metrics SweepRunner::RunCase(const ChronoSimulation::Config& config) const {
+    Metrics metrics;
+    auto wall_start = std::chrono::steady_clock::now();
+
+    ChronoSimulation sim(config);
+    sim.Initialize();
+    // Parallelism comes from running cases side by side
+    sim.GetSystem()->SetNumThreads(1, 1, 1);
+
+    ChVector3d last = sim.GetVehicleState(0).pos;
+    int steps = (int)std::lround(config.duration / sim.GetStepSize());
+    for (int i = 0; i < steps; i++) {
+        sim.Advance(1);
+        ChVector3d pos = sim.GetVehicleState(0).pos;
+        if (!std::isfinite(pos.x()) || !std::isfinite(pos.y()) || !std::isfinite(pos.z())) {
+            metrics.status = "diverged";
+            break;
+        }
+        metrics.distance += (pos - last).Length();
+        metrics.maxSinkage = std::max(metrics.maxSinkage, sim.GetMaxSinkage());
+        last = pos;
+    }
+
+    metrics.simTime = sim.GetSystem()->GetChTime();
+    metrics.meanSpeed = metrics.simTime > 0 ? metrics.distance / metrics.simTime : 0;
+    metrics.finalPos = last;
+    metrics.finalSinkage = metrics.status == "ok" ? sim.GetMaxSinkage() : 0;
+    metrics.wallTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+    return metrics;
+}
+
+void SweepRunner::WriteRow(size_t index, const std::vector<double>& values, const Metrics& metrics) {
+    std::lock_guard<std::mutex> lock(output_mutex_);
+    output_ << index;
+    for (double value : values) {
+        output_ << "," << value;
+    }
+    double rtf = metrics.simTime > 0 ? metrics.wallTime / metrics.simTime : 0;
+    output_ << "," << metrics.status << "," << metrics.simTime << "," << metrics.distance << ","
+            << metrics.meanSpeed << "," << metrics.finalPos.x() << "," << metrics.finalPos.y() << ","
+            << metrics.finalPos.z() << "," << metrics.maxSinkage << "," << metrics.finalSinkage << ","
+            << metrics.wallTime << "," << rtf << std::endl;
+    std::cout << "Sweep: case " << index + 1 << "/" << GetNumCases() << " " << metrics.status << " in "
+              << metrics.wallTime << " s" << std::endl;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "main.h"
+
+// Headless parameter sweeps for soil and solver calibration. The grid file lists one parameter
+// per line followed by its values; every combination is one case:
+//
+//     # name      values...
+//     soilKphi    1e5 2e5 5e5
+//     soilN       0.8 1.0 1.1
+//     stepSize    1e-3 2e-3
+//
+// Each case runs the scripted maneuver (or the input trace given with --replay-inputs) for the
+// configured duration on a single-threaded simulation, cases side by side on a worker pool.
+// The heightmap scale is measured once per grid spacing through TerrainSource; each case still
+// loads the heightmap into its own SCM terrain, which it deforms. One CSV row is written per
+// case as soon as it finishes, so an interrupted campaign keeps its results.
+class SweepRunner {
+public:
+    struct Settings {
+        std::string gridFile;    // Parameter grid, empty = no sweep
+        std::string outputFile;  // Summary CSV, one row per case
+        int workers;             // Cases run at once, 0 = one per hardware thread
+
+        Settings();
+    };
+
+    struct Parameter {
+        std::string name;  // Config field, see GetParameterNames()
+        std::vector<double> values;
+    };
+
+    SweepRunner(const ChronoSimulation::Config& base, const Settings& settings);
+
+    // Read the grid file; false (with a message on stderr) if it is missing or invalid
+    bool LoadGrid();
+
+    size_t GetNumCases() const;
+
+    // Run every case and write the summary; false if the output cannot be written
+    bool Run();
+
+    // Config fields a grid may sweep
+    static std::vector<std::string> GetParameterNames();
+
+private:
+    struct Metrics {
+        std::string status = "ok";  // ok, diverged, error
+        double simTime = 0;
+        double distance = 0;        // Path length of vehicle 0 (m)
+        double meanSpeed = 0;       // distance / simTime (m/s)
+        chrono::ChVector3d finalPos;
+        double maxSinkage = 0;      // Deepest wheel sinkage of any vehicle during the case (m)
+        double finalSinkage = 0;    // (m)
+        double wallTime = 0;        // (s)
+    };
+
+    std::vector<double> CaseValues(size_t index) const;
+    ChronoSimulation::Config MakeCase(const std::vector<double>& values) const;
+    Metrics RunCase(const ChronoSimulation::Config& config) const;
+    void WriteRow(size_t index, const std::vector<double>& values, const Metrics& metrics);
+
+    ChronoSimulation::Config base_;
+    Settings settings_;
+    std::vector<Parameter> grid_;
+
+    std::mutex output_mutex_;
+    std::ofstream output_;
+};
@@ -0,0 +1,41 @@
+#include "task_scheduler.hpp"
+#include <cmath>
+
+int TaskScheduler::AddTask(const std::string& name, double period, double phase, TaskFunction fn) {
+    tasks_.push_back({name, period, phase, phase, -1, fn});
+    return (int)tasks_.size() - 1;
+}
+
+void TaskScheduler::SetPeriod(int id, double period) {
+    Task& task = tasks_[id];
+    task.period = period;
+    // Reschedule relative to the last run so a rate change takes effect immediately
+    if (task.last_time >= 0) {
+        task.next_time = task.last_time + period;
+    }
+}
+
+void TaskScheduler::Run(double time) {
+    // Small tolerance so accumulated step round-off does not skip a due task
+    const double eps = 1e-9;
+
+    for (auto& task : tasks_) {
+        // Sim time went backwards (snapshot restore): run now and rejoin the grid from here
+        if (task.last_time >= 0 && time + eps < task.last_time) {
+            task.next_time = time;
+        }
+
+        if (time + eps < task.next_time) continue;
+
+        task.fn(time);
+        task.last_time = time;
+
+        if (task.period <= 0) {
+            task.next_time = time;
+        } else {
+            // Next slot on the phase grid strictly after now; missed slots are dropped, not replayed
+            double slots = std::floor((time + eps - task.phase) / task.period) + 1;
+            task.next_time = task.phase + slots * task.period;
+        }
+    }
+}
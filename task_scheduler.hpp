@@ -0,0 +1,37 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+// Runs registered tasks at their own rates in simulation time. The main loop calls
+// Run() once per I/O cycle; each task fires when its next due time has been reached.
+// A period of 0 makes a task fire on every cycle. If time moves backwards (a restored
+// snapshot) every task fires on the next Run() and continues from the new time.
+class TaskScheduler {
+public:
+    using TaskFunction = std::function<void(double time)>;
+
+    // Register a task with its period and phase (both in seconds of sim time).
+    // Returns the task id used by SetPeriod/GetPeriod.
+    int AddTask(const std::string& name, double period, double phase, TaskFunction fn);
+
+    void SetPeriod(int id, double period);
+    double GetPeriod(int id) const { return tasks_[id].period; }
+    const std::string& GetName(int id) const { return tasks_[id].name; }
+
+    // Run every task that is due at the given sim time
+    void Run(double time);
+
+private:
+    struct Task {
+        std::string name;
+        double period;
+        double phase;
+        double next_time;
+        double last_time;
+        TaskFunction fn;
+    };
+
+    std::vector<Task> tasks_;
+};
@@ -0,0 +1,225 @@
+#include "terrain_coupling.hpp"
+#include "thread_budget.hpp"
+#include "terrain_node.hpp"
+#include "chrono/physics/ChContactMaterialNSC.h"
+#include "chrono/collision/ChCollisionShapeCylinder.h"
+#include <iostream>
+#include <stdexcept>
+#include <unistd.h>
+
+using namespace chrono;
+using namespace chrono::vehicle;
+
+TerrainCoupling::TerrainCoupling(const std::vector<ChWheeledVehicle*>& vehicles, const std::string& terrain_node)
+    : work_pending_(false)
+    , work_done_(true)
+    , stop_(false)
+    , step_(0)
+    , node_socket_(-1) {
+    // Proxies are repositioned every step, so gravity would only add drift
+    system_.SetGravitationalAcceleration(ChVector3d(0, 0, 0));
+    system_.SetCollisionSystemType(ChCollisionSystem::Type::BULLET);
+
+    for (auto vehicle : vehicles) {
+        for (auto& axle : vehicle->GetAxles()) {
+            for (auto& wheel : axle->GetWheels()) {
+                auto spindle = wheel->GetSpindle();
+                AddProxy({wheel->GetTire()->GetRadius(), wheel->GetTire()->GetWidth(), spindle->GetPos(),
+                          spindle->GetRot()});
+                spindles_.push_back(spindle);
+            }
+        }
+    }
+
+    states_.resize(spindles_.size());
+    forces_.resize(spindles_.size(), WheelForce{VNULL, VNULL});
+    new_forces_.resize(spindles_.size(), WheelForce{VNULL, VNULL});
+
+    if (!terrain_node.empty()) {
+        ConnectNode(terrain_node);
+        std::cout << "Explicit terrain coupling with " << proxies_.size() << " wheels on terrain node "
+                  << terrain_node << std::endl;
+        return;
+    }
+    worker_ = std::thread(&TerrainCoupling::WorkerLoop, this);
+    std::cout << "Explicit terrain coupling with " << proxies_.size() << " wheel proxies" << std::endl;
+}
+
+TerrainCoupling::TerrainCoupling(const std::vector<WheelGeometry>& wheels)
+    : work_pending_(false)
+    , work_done_(true)
+    , stop_(false)
+    , step_(0)
+    , node_socket_(-1) {
+    system_.SetGravitationalAcceleration(ChVector3d(0, 0, 0));
+    system_.SetCollisionSystemType(ChCollisionSystem::Type::BULLET);
+    for (const auto& wheel : wheels) {
+        AddProxy(wheel);
+    }
+}
+
+void TerrainCoupling::AddProxy(const WheelGeometry& wheel) {
+    // SCM ray-casts against the proxy; a cylinder along the spindle axis stands in for the tire
+    auto material = chrono_types::make_shared<ChContactMaterialNSC>();
+    auto proxy = chrono_types::make_shared<ChBody>();
+    proxy->SetPos(wheel.pos);
+    proxy->SetRot(wheel.rot);
+    auto shape = chrono_types::make_shared<ChCollisionShapeCylinder>(material, wheel.radius, wheel.width);
+    proxy->AddCollisionShape(shape, ChFrame<>(VNULL, QuatFromAngleX(CH_PI_2)));
+    proxy->EnableCollision(true);
+    system_.AddBody(proxy);
+
+    proxies_.push_back(proxy);
+    radii_.push_back(wheel.radius);
+    widths_.push_back(wheel.width);
+}
+
+void TerrainCoupling::ConnectNode(const std::string& address) {
+    node_socket_ = TerrainNode::Connect(address);
+    if (node_socket_ < 0) {
+        throw std::runtime_error("Cannot reach terrain node at " + address);
+    }
+
+    // Handshake: wheel geometry out, then wait until the node has built its terrain
+    uint32_t header[2] = {TerrainNode::kMagic, (uint32_t)proxies_.size()};
+    std::vector<double> geometry;
+    for (size_t i = 0; i < proxies_.size(); i++) {
+        ChVector3d pos = proxies_[i]->GetPos();
+        ChQuaternion<> rot = proxies_[i]->GetRot();
+        geometry.insert(geometry.end(), {radii_[i], widths_[i], pos.x(), pos.y(), pos.z(), rot.e0(), rot.e1(),
+                                         rot.e2(), rot.e3()});
+    }
+    uint32_t ready = 0;
+    if (!TerrainNode::WriteAll(node_socket_, header, sizeof(header)) ||
+        !TerrainNode::WriteAll(node_socket_, geometry.data(), geometry.size() * sizeof(double)) ||
+        !TerrainNode::ReadAll(node_socket_, &ready, sizeof(ready)) || ready != TerrainNode::kMagic) {
+        // The destructor does not run for a constructor that throws
+        close(node_socket_);
+        node_socket_ = -1;
+        throw std::runtime_error("Terrain node handshake failed at " + address);
+    }
+}
+
+TerrainCoupling::~TerrainCoupling() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+    if (node_socket_ >= 0) {
+        close(node_socket_);
+    }
+}
+
+void TerrainCoupling::AttachTerrain(std::shared_ptr<SCMTerrain> terrain) {
+    terrain_ = terrain;
+    // A remote node deforms its own terrain; the local one only answers height queries
+    if (IsRemote()) return;
+    for (size_t i = 0; i < proxies_.size(); i++) {
+        double diameter = 2 * radii_[i];
+        terrain_->AddMovingPatch(proxies_[i], VNULL, ChVector3d(diameter, widths_[i] * 1.5, diameter));
+    }
+}
+
+void TerrainCoupling::ApplyForces() {
+    for (size_t i = 0; i < spindles_.size(); i++) {
+        spindles_[i]->EmptyAccumulators();
+        spindles_[i]->AccumulateForce(forces_[i].force, spindles_[i]->GetPos(), false);
+        spindles_[i]->AccumulateTorque(forces_[i].torque, false);
+    }
+}
+
+void TerrainCoupling::BeginStep(double step) {
+    for (size_t i = 0; i < spindles_.size(); i++) {
+        states_[i].pos = spindles_[i]->GetPos();
+        states_[i].rot = spindles_[i]->GetRot();
+        states_[i].linVel = spindles_[i]->GetPosDt();
+        states_[i].angVel = spindles_[i]->GetAngVelParent();
+    }
+
+    // The node steps while the vehicle does; EndStep() collects its forces
+    if (IsRemote()) {
+        std::vector<double> message{step};
+        for (const auto& state : states_) {
+            message.insert(message.end(), {state.pos.x(), state.pos.y(), state.pos.z(), state.rot.e0(), state.rot.e1(),
+                                           state.rot.e2(), state.rot.e3(), state.linVel.x(), state.linVel.y(),
+                                           state.linVel.z(), state.angVel.x(), state.angVel.y(), state.angVel.z()});
+        }
+        if (!TerrainNode::WriteAll(node_socket_, message.data(), message.size() * sizeof(double))) {
+            throw std::runtime_error("Lost the terrain node");
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        step_ = step;
+        work_pending_ = true;
+        work_done_ = false;
+    }
+    cv_.notify_all();
+}
+
+void TerrainCoupling::EndStep() {
+    if (IsRemote()) {
+        std::vector<double> message(forces_.size() * 6);
+        if (!TerrainNode::ReadAll(node_socket_, message.data(), message.size() * sizeof(double))) {
+            throw std::runtime_error("Lost the terrain node");
+        }
+        for (size_t i = 0; i < forces_.size(); i++) {
+            const double* f = &message[i * 6];
+            forces_[i].force = ChVector3d(f[0], f[1], f[2]);
+            forces_[i].torque = ChVector3d(f[3], f[4], f[5]);
+        }
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this]() { return work_done_; });
+    std::swap(forces_, new_forces_);
+}
+
+void TerrainCoupling::StepTerrain(const std::vector<WheelState>& states, double step, std::vector<WheelForce>& forces) {
+    for (size_t i = 0; i < proxies_.size(); i++) {
+        proxies_[i]->SetPos(states[i].pos);
+        proxies_[i]->SetRot(states[i].rot);
+        proxies_[i]->SetPosDt(states[i].linVel);
+        proxies_[i]->SetAngVelParent(states[i].angVel);
+    }
+
+    system_.DoStepDynamics(step);
+
+    for (size_t i = 0; i < proxies_.size(); i++) {
+        if (!terrain_->GetContactForceBody(proxies_[i], forces[i].force, forces[i].torque)) {
+            forces[i].force = VNULL;
+            forces[i].torque = VNULL;
+        }
+    }
+}
+
+void TerrainCoupling::WorkerLoop() {
+    // Terrain work competes with the vehicle solve, so it shares the physics core set
+    ThreadBudget::PinCurrentThread(ThreadBudget::Role::PHYSICS);
+
+    while (true) {
+        double step;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this]() { return work_pending_ || stop_; });
+            if (stop_) return;
+            work_pending_ = false;
+            step = step_;
+        }
+
+        StepTerrain(states_, step, new_forces_);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            work_done_ = true;
+        }
+        cv_.notify_all();
+    }
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "chrono/physics/ChSystemNSC.h"
+#include "chrono/physics/ChBody.h"
+#include "chrono_vehicle/wheeled_vehicle/ChWheeledVehicle.h"
+#include "chrono_vehicle/terrain/SCMTerrain.h"
+
+// Explicit (one-step lagged) vehicle/terrain coupling. SCM lives in its own system where each
+// wheel is represented by a proxy body. Each step the proxies take the current wheel states
+// and the terrain step runs on a worker thread, concurrently with the vehicle step. The
+// resulting forces are applied to the spindles on the next step. With a terrain node address
+// the terrain step runs in a separate process instead (see TerrainNode).
+class TerrainCoupling {
+public:
+    // Kinematic state of one wheel as seen by the terrain
+    struct WheelState {
+        chrono::ChVector3d pos;
+        chrono::ChQuaternion<> rot;
+        chrono::ChVector3d linVel;
+        chrono::ChVector3d angVel;  // Absolute frame
+    };
+
+    // Terrain reaction on one wheel, reduced to the spindle center (absolute frame)
+    struct WheelForce {
+        chrono::ChVector3d force;
+        chrono::ChVector3d torque;
+    };
+
+    // Wheel proxy shape and initial pose
+    struct WheelGeometry {
+        double radius;
+        double width;
+        chrono::ChVector3d pos;
+        chrono::ChQuaternion<> rot;
+    };
+
+    // Vehicle side. The terrain steps on a worker thread, or in the terrain node at
+    // `terrain_node` if given. Throws std::runtime_error if the node cannot be reached, and
+    // BeginStep()/EndStep() throw if the connection is lost.
+    TerrainCoupling(const std::vector<chrono::vehicle::ChWheeledVehicle*>& vehicles,
+                    const std::string& terrain_node = "");
+
+    // Terrain node side: proxies only, stepped by the caller through StepTerrain()
+    explicit TerrainCoupling(const std::vector<WheelGeometry>& wheels);
+
+    ~TerrainCoupling();
+
+    // The terrain runs in another process; the local SCM terrain is never stepped
+    bool IsRemote() const { return node_socket_ >= 0; }
+
+    // System the SCM terrain must be created in
+    chrono::ChSystem* GetSystem() { return &system_; }
+
+    // Register a moving patch around every wheel proxy; call before terrain->Initialize()
+    void AttachTerrain(std::shared_ptr<chrono::vehicle::SCMTerrain> terrain);
+
+    // Apply the forces from the previous terrain step to the spindles (after vehicle Synchronize)
+    void ApplyForces();
+
+    // Hand the current wheel states to the terrain and start its step on the worker thread
+    void BeginStep(double step);
+
+    // Wait for the terrain step started by BeginStep; its forces are used by the next ApplyForces
+    void EndStep();
+
+    // Lagged forces waiting to be applied; saved and restored with simulation snapshots
+    const std::vector<WheelForce>& GetForces() const { return forces_; }
+    void SetForces(const std::vector<WheelForce>& forces) { forces_ = forces; }
+
+    // Terrain side of a step: move the proxies to the wheel states, step SCM, read the forces
+    void StepTerrain(const std::vector<WheelState>& states, double step, std::vector<WheelForce>& forces);
+
+private:
+    void AddProxy(const WheelGeometry& wheel);
+    void ConnectNode(const std::string& address);
+    void WorkerLoop();
+
+    chrono::ChSystemNSC system_;
+    std::shared_ptr<chrono::vehicle::SCMTerrain> terrain_;
+    std::vector<std::shared_ptr<chrono::ChBody>> spindles_;
+    std::vector<std::shared_ptr<chrono::ChBody>> proxies_;
+    std::vector<double> radii_;
+    std::vector<double> widths_;
+
+    std::vector<WheelState> states_;
+    std::vector<WheelForce> forces_;       // Applied to the vehicle
+    std::vector<WheelForce> new_forces_;   // Being computed by the worker
+
+    std::thread worker_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool work_pending_;
+    bool work_done_;
+    bool stop_;
+    double step_;
+    int node_socket_;  // Connection to the terrain node, -1 when in-process
+};
@@ -0,0 +1,248 @@
+#include "terrain_node.hpp"
+
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <netdb.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <vector>
+
+#include "terrain_source.hpp"
+#include "thread_budget.hpp"
+
+using namespace chrono;
+using namespace chrono::vehicle;
+
+namespace {
+const std::string kUnixPrefix = "unix:";
+const uint32_t kMaxWheels = 4096;  // Bound on the handshake's wheel count before allocating for it
+
+// "unix:/path" or "host:port" (a bare port means all interfaces)
+bool ParseInet(const std::string& address, std::string& host, int& port) {
+    size_t colon = address.rfind(':');
+    host = colon == std::string::npos ? "" : address.substr(0, colon);
+    try {
+        port = std::stoi(colon == std::string::npos ? address : address.substr(colon + 1));
+    } catch (const std::exception& e) {
+        return false;
+    }
+    return true;
+}
+
+bool MakeUnixAddress(const std::string& address, sockaddr_un& un) {
+    std::string path = address.substr(kUnixPrefix.size());
+    if (path.empty() || path.size() >= sizeof(un.sun_path)) return false;
+    memset(&un, 0, sizeof(un));
+    un.sun_family = AF_UNIX;
+    strncpy(un.sun_path, path.c_str(), sizeof(un.sun_path) - 1);
+    return true;
+}
+
+void SetNoDelay(int fd) {
+    // One small message per step in each direction; Nagle would hold every one of them back
+    int opt = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt));
+}
+}  // namespace
+
+TerrainNode::TerrainNode(const ChronoSimulation::Config& config, const std::string& address)
+    : config_(config), address_(address), listen_socket_(-1), socket_(-1) {}
+
+TerrainNode::~TerrainNode() {
+    if (socket_ >= 0) {
+        close(socket_);
+    }
+    if (listen_socket_ >= 0) {
+        close(listen_socket_);
+    }
+    if (address_.compare(0, kUnixPrefix.size(), kUnixPrefix) == 0) {
+        unlink(address_.substr(kUnixPrefix.size()).c_str());
+    }
+}
+
+int TerrainNode::Connect(const std::string& address) {
+    if (address.compare(0, kUnixPrefix.size(), kUnixPrefix) == 0) {
+        sockaddr_un un;
+        if (!MakeUnixAddress(address, un)) return -1;
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd >= 0 && connect(fd, (struct sockaddr*)&un, sizeof(un)) == 0) return fd;
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+
+    std::string host;
+    int port;
+    if (!ParseInet(address, host, port)) return -1;
+    addrinfo hints{};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* result = nullptr;
+    if (getaddrinfo(host.empty() ? "127.0.0.1" : host.c_str(), std::to_string(port).c_str(), &hints, &result) != 0) {
+        return -1;
+    }
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd >= 0 && connect(fd, result->ai_addr, result->ai_addrlen) != 0) {
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(result);
+    if (fd >= 0) {
+        SetNoDelay(fd);
+    }
+    return fd;
+}
+
+int TerrainNode::Listen(const std::string& address) {
+    int fd = -1;
+    if (address.compare(0, kUnixPrefix.size(), kUnixPrefix) == 0) {
+        sockaddr_un un;
+        if (!MakeUnixAddress(address, un)) return -1;
+        unlink(un.sun_path);
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd >= 0 && bind(fd, (struct sockaddr*)&un, sizeof(un)) != 0) {
+            close(fd);
+            return -1;
+        }
+    } else {
+        std::string host;
+        int port;
+        if (!ParseInet(address, host, port)) return -1;
+        sockaddr_in in{};
+        in.sin_family = AF_INET;
+        in.sin_port = htons(port);
+        in.sin_addr.s_addr = INADDR_ANY;
+        if (!host.empty() && inet_pton(AF_INET, host.c_str(), &in.sin_addr) != 1) return -1;
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        int opt = 1;
+        if (fd >= 0) {
+            setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+        }
+        if (fd >= 0 && bind(fd, (struct sockaddr*)&in, sizeof(in)) != 0) {
+            close(fd);
+            return -1;
+        }
+    }
+    if (fd >= 0 && listen(fd, 1) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool TerrainNode::WriteAll(int fd, const void* data, size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t sent = send(fd, bytes, size, MSG_NOSIGNAL);
+        if (sent <= 0) return false;
+        bytes += sent;
+        size -= sent;
+    }
+    return true;
+}
+
+bool TerrainNode::ReadAll(int fd, void* data, size_t size) {
+    char* bytes = static_cast<char*>(data);
+    while (size > 0) {
+        ssize_t received = recv(fd, bytes, size, 0);
+        if (received <= 0) return false;
+        bytes += received;
+        size -= received;
+    }
+    return true;
+}
+
+bool TerrainNode::Run() {
+    listen_socket_ = Listen(address_);
+    if (listen_socket_ < 0) {
+        std::cerr << "Terrain node: cannot listen on " << address_ << std::endl;
+        return false;
+    }
+    std::cout << "Terrain node: waiting for the vehicle process on " << address_ << std::endl;
+    socket_ = accept(listen_socket_, nullptr, nullptr);
+    if (socket_ < 0) {
+        std::cerr << "Terrain node: accept failed" << std::endl;
+        return false;
+    }
+    if (address_.compare(0, kUnixPrefix.size(), kUnixPrefix) != 0) {
+        SetNoDelay(socket_);
+    }
+
+    // Handshake: the vehicle process sends its wheel geometry
+    uint32_t header[2];
+    if (!ReadAll(socket_, header, sizeof(header)) || header[0] != kMagic || header[1] > kMaxWheels) {
+        std::cerr << "Terrain node: bad handshake" << std::endl;
+        return false;
+    }
+    size_t wheels = header[1];
+    std::vector<double> geometry(wheels * 9);
+    if (!ReadAll(socket_, geometry.data(), geometry.size() * sizeof(double))) {
+        std::cerr << "Terrain node: bad handshake" << std::endl;
+        return false;
+    }
+    std::vector<TerrainCoupling::WheelGeometry> wheel_geometry;
+    for (size_t i = 0; i < wheels; i++) {
+        const double* g = &geometry[i * 9];
+        wheel_geometry.push_back({g[0], g[1], ChVector3d(g[2], g[3], g[4]), ChQuaternion<>(g[5], g[6], g[7], g[8])});
+    }
+    coupling_ = std::make_shared<TerrainCoupling>(wheel_geometry);
+
+    // Same soil and mesh as ChronoSimulation::SetupTerrain() builds in-process
+    TerrainSource::Shape shape{config_.heightmapFile, config_.terrainHeight, config_.terrainWidth, config_.terrainZ,
+                               config_.terrainDelta};
+    auto source = TerrainSource::Get(shape);
+    terrain_ = std::make_shared<SCMTerrain>(coupling_->GetSystem());
+    terrain_->SetSoilParameters(config_.soilKphi, config_.soilKc, config_.soilN, config_.soilCohesion,
+                                config_.soilFriction, config_.soilJanosi, config_.soilStiffness, config_.soilDamping);
+    coupling_->AttachTerrain(terrain_);
+    terrain_->Initialize(config_.heightmapFile, config_.terrainHeight, config_.terrainWidth, 0, source->GetScale(),
+                         config_.terrainDelta);
+    ThreadBudget::ApplyToSystem(coupling_->GetSystem());
+
+    uint32_t ready = kMagic;
+    if (!WriteAll(socket_, &ready, sizeof(ready))) {
+        std::cerr << "Terrain node: vehicle process went away" << std::endl;
+        return false;
+    }
+    std::cout << "Terrain node: serving " << wheels << " wheels, delta " << config_.terrainDelta << std::endl;
+
+    // One step per message until the vehicle process disconnects
+    std::vector<double> request(1 + wheels * 13);
+    std::vector<double> reply(wheels * 6);
+    std::vector<TerrainCoupling::WheelState> states(wheels);
+    std::vector<TerrainCoupling::WheelForce> forces(wheels);
+    uint64_t steps = 0;
+    double busy = 0;
+    auto start = std::chrono::steady_clock::now();
+    while (ReadAll(socket_, request.data(), request.size() * sizeof(double))) {
+        auto step_start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < wheels; i++) {
+            const double* s = &request[1 + i * 13];
+            states[i].pos = ChVector3d(s[0], s[1], s[2]);
+            states[i].rot = ChQuaternion<>(s[3], s[4], s[5], s[6]);
+            states[i].linVel = ChVector3d(s[7], s[8], s[9]);
+            states[i].angVel = ChVector3d(s[10], s[11], s[12]);
+        }
+        coupling_->StepTerrain(states, request[0], forces);
+        for (size_t i = 0; i < wheels; i++) {
+            double* f = &reply[i * 6];
+            f[0] = forces[i].force.x();
+            f[1] = forces[i].force.y();
+            f[2] = forces[i].force.z();
+            f[3] = forces[i].torque.x();
+            f[4] = forces[i].torque.y();
+            f[5] = forces[i].torque.z();
+        }
+        if (!WriteAll(socket_, reply.data(), reply.size() * sizeof(double))) break;
+        busy += std::chrono::duration<double>(std::chrono::steady_clock::now() - step_start).count();
+        steps++;
+    }
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Terrain node: " << steps << " steps in " << elapsed << " s, " << (steps ? busy / steps * 1e3 : 0)
+              << " ms per terrain step" << std::endl;
+    return true;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "main.h"
+
+// SCM terrain in its own process. The vehicle process runs explicit coupling with the terrain
+// step replaced by a round trip to this node: each step it sends the wheel states and reads
+// back the forces of the previous terrain step, so the node solves SCM while the vehicle
+// solves its multibody system. Start the node with the same terrain and soil options as the
+// vehicle process; it serves one vehicle process and exits when that one disconnects.
+//
+// Addresses are "host:port" (TCP, e.g. loopback or another node) or "unix:/path" (Unix domain
+// socket, for the lowest latency on one machine). Data is sent in host byte order, so both
+// sides must run on the same architecture.
+class TerrainNode {
+public:
+    TerrainNode(const ChronoSimulation::Config& config, const std::string& address);
+    ~TerrainNode();
+
+    // Wait for the vehicle process and serve its steps; false on a setup or protocol error
+    bool Run();
+
+    // Stream socket helpers shared with the vehicle side (TerrainCoupling)
+    static int Connect(const std::string& address);
+    static bool WriteAll(int fd, const void* data, size_t size);
+    static bool ReadAll(int fd, void* data, size_t size);
+
+    static const uint32_t kMagic = 0x53434d31;  // "SCM1"
+
+private:
+    static int Listen(const std::string& address);
+
+    ChronoSimulation::Config config_;
+    std::string address_;
+    int listen_socket_;
+    int socket_;
+    std::shared_ptr<TerrainCoupling> coupling_;
+    std::shared_ptr<chrono::vehicle::SCMTerrain> terrain_;
+};
@@ -0,0 +1,59 @@
+#include "terrain_source.hpp"
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <limits>
+
+#include "chrono/physics/ChSystemNSC.h"
+#include "chrono_vehicle/terrain/SCMTerrain.h"
+
+using namespace chrono;
+using namespace chrono::vehicle;
+
+std::mutex TerrainSource::cache_mutex_;
+std::map<TerrainSource::Key, std::shared_ptr<const TerrainSource>> TerrainSource::cache_;
+
+std::shared_ptr<const TerrainSource> TerrainSource::Get(const Shape& shape) {
+    struct stat info;
+    long mtime = stat(shape.heightmapFile.c_str(), &info) == 0 ? (long)info.st_mtime : 0;
+    Key key(shape.heightmapFile, mtime, shape.sizeX, shape.sizeY, shape.height, shape.delta);
+
+    // Measuring under the lock makes simulations that start together wait for one
+    // measurement instead of each building their own throwaway terrain
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    auto it = cache_.find(key);
+    if (it != cache_.end()) {
+        return it->second;
+    }
+    std::shared_ptr<const TerrainSource> source(new TerrainSource(shape));
+    cache_[key] = source;
+    return source;
+}
+
+TerrainSource::TerrainSource(const Shape& shape) : shape_(shape), min_z_(0), scale_(shape.height) {
+    auto start = std::chrono::steady_clock::now();
+
+    // SCM adds its loader to the system it is created in, so measure on a throwaway system
+    ChSystemNSC tmp_system;
+    SCMTerrain terrain(&tmp_system);
+    terrain.Initialize(shape.heightmapFile, shape.sizeX, shape.sizeY, 0, shape.height, shape.delta);
+
+    double min_z = std::numeric_limits<double>::max();
+    double max_z = std::numeric_limits<double>::lowest();
+    for (const auto& v : terrain.GetMesh()->GetMesh()->GetCoordsVertices()) {
+        min_z = std::min(min_z, v.z());
+        max_z = std::max(max_z, v.z());
+    }
+
+    min_z_ = min_z;
+    if (max_z > min_z) {
+        scale_ = shape.height * shape.height / (max_z - min_z);
+    }
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Measured terrain " << shape.heightmapFile << ": min z " << min_z_ << ", scale " << scale_
+              << " (" << elapsed << " s)" << std::endl;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+
+// Vertical extent of a heightmap terrain as SCM builds it. Measuring it means building a
+// complete SCM terrain, so it is done once per heightmap and shape and the result is shared
+// by every simulation in the process. Only the measurement is shared: SCMTerrain::Initialize
+// takes a file path and decodes and grids the heightmap into its own private height table,
+// with no way to hand it height data loaded elsewhere, so every terrain still loads the file.
+class TerrainSource {
+public:
+    struct Shape {
+        std::string heightmapFile;
+        double sizeX;   // Terrain length (m)
+        double sizeY;   // Terrain width (m)
+        double height;  // Height (m) the mesh should span from its lowest to its highest vertex
+        double delta;   // SCM grid spacing (m)
+    };
+
+    // Cached source for the shape; the heightmap is measured on first use. Thread-safe.
+    static std::shared_ptr<const TerrainSource> Get(const Shape& shape);
+
+    const Shape& GetShape() const { return shape_; }
+
+    // Lowest mesh vertex when initialized with the nominal height
+    double GetMinZ() const { return min_z_; }
+
+    // Height scale to pass to SCMTerrain::Initialize so the mesh spans exactly shape.height
+    double GetScale() const { return scale_; }
+
+private:
+    explicit TerrainSource(const Shape& shape);
+
+    Shape shape_;
+    double min_z_;
+    double scale_;
+
+    // The file modification time is part of the key, so an edited heightmap is measured again
+    using Key = std::tuple<std::string, long, double, double, double, double>;
+    static std::mutex cache_mutex_;
+    static std::map<Key, std::shared_ptr<const TerrainSource>> cache_;
+};
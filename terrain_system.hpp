@@ -110,6 +110,14 @@ public:
         return ChVector3d(x, y, z);
     }
 
+    ChVector3d convertUEToChronoRotation(ChVector3d point)
+    {
+        double x = point.x();
+        double y = -point.y();
+        double z = -point.z();
+        return ChVector3d(x, y, z);
+    }
+
     ~TerrainSystemCoordinates() {}
 };
 #endif
\ No newline at end of file
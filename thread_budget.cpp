@@ -0,0 +1,105 @@
+#include "thread_budget.hpp"
+#include "chrono/physics/ChSystem.h"
+#include <cstring>
+#include <iostream>
+#include <pthread.h>
+#include <sched.h>
+#include <set>
+#include <sstream>
+
+namespace {
+ThreadBudget::Settings g_settings;
+}
+
+ThreadBudget::Settings::Settings()
+    : chronoThreads(0)
+    , collisionThreads(0)
+    , eigenThreads(0) {}
+
+void ThreadBudget::Configure(const Settings& settings) {
+    g_settings = settings;
+
+    // Overlapping sets defeat the purpose of the budget, so say so loudly
+    std::set<int> seen;
+    for (const auto* cpus : {&settings.physicsCpus, &settings.ioCpus, &settings.renderCpus}) {
+        for (int cpu : *cpus) {
+            if (!seen.insert(cpu).second) {
+                std::cerr << "Thread budget: CPU " << cpu << " is assigned to more than one role" << std::endl;
+            }
+        }
+    }
+}
+
+const ThreadBudget::Settings& ThreadBudget::GetSettings() {
+    return g_settings;
+}
+
+void ThreadBudget::PinCurrentThread(Role role) {
+    const std::vector<int>* cpus = nullptr;
+    switch (role) {
+        case Role::PHYSICS: cpus = &g_settings.physicsCpus; break;
+        case Role::IO: cpus = &g_settings.ioCpus; break;
+        case Role::RENDER: cpus = &g_settings.renderCpus; break;
+    }
+    if (!cpus || cpus->empty()) return;
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : *cpus) {
+        CPU_SET(cpu, &set);
+    }
+    int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (err != 0) {
+        std::cerr << "Failed to pin " << RoleName(role) << " thread: " << strerror(err) << std::endl;
+    }
+}
+
+void ThreadBudget::ApplyToSystem(chrono::ChSystem* system) {
+    int chrono_threads = g_settings.chronoThreads;
+    if (chrono_threads <= 0) {
+        chrono_threads = (int)g_settings.physicsCpus.size();
+    }
+    if (chrono_threads <= 0 && g_settings.collisionThreads <= 0 && g_settings.eigenThreads <= 0) return;
+
+    // Keep Chrono's own defaults for anything the budget leaves unset
+    if (chrono_threads <= 0) chrono_threads = system->GetNumThreadsChrono();
+    int collision_threads = g_settings.collisionThreads > 0 ? g_settings.collisionThreads
+                                                            : system->GetNumThreadsCollision();
+    int eigen_threads = g_settings.eigenThreads > 0 ? g_settings.eigenThreads : system->GetNumThreadsEigen();
+
+    system->SetNumThreads(chrono_threads, collision_threads, eigen_threads);
+    std::cout << "Chrono threads: chrono=" << chrono_threads << " collision=" << collision_threads
+              << " eigen=" << eigen_threads << std::endl;
+}
+
+bool ThreadBudget::ParseCpuList(const std::string& text, std::vector<int>& cpus) {
+    cpus.clear();
+    std::stringstream ss(text);
+    std::string item;
+    try {
+        while (std::getline(ss, item, ',')) {
+            auto dash = item.find('-');
+            if (dash == std::string::npos) {
+                cpus.push_back(std::stoi(item));
+            } else {
+                int first = std::stoi(item.substr(0, dash));
+                int last = std::stoi(item.substr(dash + 1));
+                for (int cpu = first; cpu <= last; cpu++) {
+                    cpus.push_back(cpu);
+                }
+            }
+        }
+    } catch (const std::exception& e) {
+        return false;
+    }
+    return !cpus.empty();
+}
+
+const char* ThreadBudget::RoleName(Role role) {
+    switch (role) {
+        case Role::PHYSICS: return "physics";
+        case Role::IO: return "I/O";
+        case Role::RENDER: return "render";
+    }
+    return "unknown";
+}
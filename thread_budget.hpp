@@ -0,0 +1,42 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace chrono {
+class ChSystem;
+}
+
+// Process-wide thread budget. Physics, I/O and render threads are pinned to their own
+// core sets, and Chrono's internal pools (OpenMP for SCM ray casting and the solver,
+// collision, Eigen) are sized to match. Configure() is called once from main() before any
+// simulation thread starts; each thread then pins itself by role.
+class ThreadBudget {
+public:
+    enum class Role { PHYSICS, IO, RENDER };
+
+    struct Settings {
+        std::vector<int> physicsCpus;  // Physics thread and the Chrono pools it spawns
+        std::vector<int> ioCpus;       // websocket client threads, TCP/ROS consumers
+        std::vector<int> renderCpus;   // Irrlicht render thread
+        int chronoThreads;             // ChSystem::SetNumThreads chrono count, 0 = size of physicsCpus
+        int collisionThreads;          // Collision detection threads, 0 = Chrono default
+        int eigenThreads;              // Eigen threads, 0 = Chrono default
+
+        Settings();
+    };
+
+    static void Configure(const Settings& settings);
+    static const Settings& GetSettings();
+
+    // Pin the calling thread to the core set of its role (no-op if the set is empty)
+    static void PinCurrentThread(Role role);
+
+    // Size Chrono's thread pools for the system according to the budget
+    static void ApplyToSystem(chrono::ChSystem* system);
+
+    // Parse a CPU list such as "0-3,6,8-9"
+    static bool ParseCpuList(const std::string& text, std::vector<int>& cpus);
+
+    static const char* RoleName(Role role);
+};
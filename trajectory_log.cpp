@@ -0,0 +1,89 @@
+#include "trajectory_log.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+namespace {
+struct Sample {
+    double time;
+    double x, y, z;
+    double yaw;
+    double speed;
+};
+
+bool ReadSamples(const std::string& filename, std::vector<Sample>& samples) {
+    std::ifstream file(filename);
+    if (!file) {
+        std::cerr << "Cannot open trajectory " << filename << std::endl;
+        return false;
+    }
+    std::string line;
+    std::getline(file, line);  // header
+    while (std::getline(file, line)) {
+        std::stringstream ss(line);
+        Sample s;
+        char sep;
+        if (ss >> s.time >> sep >> s.x >> sep >> s.y >> sep >> s.z >> sep >> s.yaw >> sep >> s.speed) {
+            samples.push_back(s);
+        }
+    }
+    return true;
+}
+}  // namespace
+
+bool TrajectoryLog::Open(const std::string& filename) {
+    file_.open(filename);
+    if (!file_) {
+        std::cerr << "Cannot open trajectory log " << filename << std::endl;
+        return false;
+    }
+    file_ << "time,x,y,z,yaw,speed" << std::endl;
+    file_ << std::setprecision(10);
+    return true;
+}
+
+void TrajectoryLog::Write(double time, const VehicleState& state) {
+    double yaw = state.rot.GetCardanAnglesXYZ().z();
+    file_ << time << "," << state.pos.x() << "," << state.pos.y() << "," << state.pos.z() << "," << yaw << ","
+          << state.vel.Length() << "\n";
+}
+
+bool TrajectoryLog::Compare(const std::string& reference, const std::string& candidate, std::ostream& os) {
+    std::vector<Sample> ref, cand;
+    if (!ReadSamples(reference, ref) || !ReadSamples(candidate, cand)) return false;
+
+    // Pair samples by time; both runs log on the same sim-time grid
+    double sum_sq = 0, max_err = 0, max_err_time = 0, max_yaw_err = 0;
+    size_t pairs = 0, j = 0;
+    for (const auto& r : ref) {
+        while (j + 1 < cand.size() && std::abs(cand[j + 1].time - r.time) <= std::abs(cand[j].time - r.time)) j++;
+        if (j >= cand.size() || std::abs(cand[j].time - r.time) > 1e-3) continue;
+
+        const auto& c = cand[j];
+        double err = std::sqrt((c.x - r.x) * (c.x - r.x) + (c.y - r.y) * (c.y - r.y) + (c.z - r.z) * (c.z - r.z));
+        double yaw_err = std::abs(std::remainder(c.yaw - r.yaw, 2 * M_PI));
+        sum_sq += err * err;
+        if (err > max_err) {
+            max_err = err;
+            max_err_time = r.time;
+        }
+        max_yaw_err = std::max(max_yaw_err, yaw_err);
+        pairs++;
+    }
+
+    if (pairs == 0) {
+        os << "No matching samples between " << reference << " and " << candidate << std::endl;
+        return false;
+    }
+
+    os << "Trajectory comparison (" << pairs << " samples)\n"
+       << "  RMS position error: " << std::sqrt(sum_sq / pairs) << " m\n"
+       << "  Max position error: " << max_err << " m at t=" << max_err_time << "\n"
+       << "  Max heading error:  " << max_yaw_err * 180 / M_PI << " deg\n"
+       << "  Final offset:       " << std::hypot(cand.back().x - ref.back().x, cand.back().y - ref.back().y)
+       << " m (t=" << ref.back().time << " / " << cand.back().time << ")" << std::endl;
+    return true;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <fstream>
+#include <string>
+#include "state_bus.hpp"
+
+// Writes chassis trajectories to CSV and compares two of them. Used to report how far an
+// alternative stepping mode drifts from the sequential baseline on the same scenario.
+class TrajectoryLog {
+public:
+    bool Open(const std::string& filename);
+    void Write(double time, const VehicleState& state);
+
+    // Print position and heading deviation of `candidate` against `reference`, sample by sample.
+    // Returns false if either file cannot be read or no samples pair up by time.
+    static bool Compare(const std::string& reference, const std::string& candidate, std::ostream& os);
+
+private:
+    std::ofstream file_;
+};
@@ -0,0 +1,158 @@
+#include "vehicle_lod.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace chrono;
+using namespace chrono::vehicle;
+
+VehicleLod::Settings::Settings()
+    : promoteRadius(60.0),
+      demoteRadius(75.0),
+      interactionRadius(15.0),
+      idleTime(10.0),
+      maxAcceleration(3.0),
+      maxDeceleration(8.0),
+      maxSpeed(20.0),
+      maxSteeringAngle(0.6),
+      rollingResistance(0.3) {}
+
+VehicleLod::VehicleLod(ChWheeledVehicle* vehicle,
+                       const std::vector<std::shared_ptr<ChBody>>& bodies,
+                       std::shared_ptr<ChTerrain> terrain,
+                       const Settings& settings)
+    : vehicle_(vehicle),
+      bodies_(bodies),
+      terrain_(terrain),
+      settings_(settings),
+      reduced_(false),
+      wheelbase_(3.0),
+      idle_time_(0),
+      x_(0), y_(0), yaw_(0), speed_(0), yaw_rate_(0),
+      ride_height_(0),
+      attitude_offset_(1, 0, 0, 0) {
+    for (auto& axle : vehicle_->GetAxles()) {
+        for (auto& wheel : axle->GetWheels()) {
+            spindles_.push_back(wheel->GetSpindle());
+            wheel_radii_.push_back(wheel->GetTire()->GetRadius());
+        }
+    }
+
+    // Same wheelbase estimate as ROSDriver: first to last axle spindle distance
+    auto front = vehicle_->GetAxle(0)->GetWheels()[0]->GetSpindle()->GetPos();
+    auto rear = vehicle_->GetAxle(vehicle_->GetNumberAxles() - 1)->GetWheels()[0]->GetSpindle()->GetPos();
+    wheelbase_ = std::max((front - rear).Length(), 0.5);
+}
+
+ChQuaternion<> VehicleLod::SurfaceRotation(const ChVector3d& pos, double yaw) const {
+    ChQuaternion<> heading = QuatFromAngleZ(yaw);
+
+    // Tilt Z onto the terrain normal
+    ChVector3d up(0, 0, 1);
+    ChVector3d normal = terrain_->GetNormal(pos).GetNormalized();
+    ChVector3d axis = up.Cross(normal);
+    double sin_angle = axis.Length();
+    if (sin_angle < 1e-9) {
+        return heading;
+    }
+    ChQuaternion<> tilt;
+    tilt.SetFromAngleAxis(std::atan2(sin_angle, up.Dot(normal)), axis / sin_angle);
+    return tilt * heading;
+}
+
+void VehicleLod::SetFixed(bool fixed) {
+    for (auto& body : bodies_) {
+        body->SetFixed(fixed);
+    }
+}
+
+void VehicleLod::SyncFromChassis() {
+    auto chassis = vehicle_->GetChassisBody();
+    ChVector3d pos = chassis->GetPos();
+    ChVector3d forward = chassis->GetRot().GetAxisX();
+
+    x_ = pos.x();
+    y_ = pos.y();
+    yaw_ = std::atan2(forward.y(), forward.x());
+    speed_ = std::min(chassis->GetPosDt().Dot(forward), settings_.maxSpeed);
+    yaw_rate_ = chassis->GetAngVelParent().z();
+    ride_height_ = pos.z() - terrain_->GetHeight(pos);
+    attitude_offset_ = SurfaceRotation(pos, yaw_).GetConjugate() * chassis->GetRot();
+}
+
+void VehicleLod::Demote() {
+    if (reduced_) return;
+    SyncFromChassis();
+    SetFixed(true);
+    reduced_ = true;
+}
+
+void VehicleLod::Promote() {
+    if (!reduced_) return;
+    SetFixed(false);
+    reduced_ = false;
+
+    // Rigid motion of the bicycle: forward speed and yaw rate for every body, plus wheel spin
+    auto chassis = vehicle_->GetChassisBody();
+    ChVector3d center = chassis->GetPos();
+    ChVector3d velocity = chassis->GetRot().GetAxisX() * speed_;
+    ChVector3d omega(0, 0, yaw_rate_);
+    for (auto& body : bodies_) {
+        body->SetPosDt(velocity + omega.Cross(body->GetPos() - center));
+        body->SetAngVelParent(omega);
+    }
+    for (size_t i = 0; i < spindles_.size(); i++) {
+        // Rolling without slip about the spindle axis (spindle Y)
+        ChVector3d spin = spindles_[i]->GetRot().Rotate(ChVector3d(0, speed_ / wheel_radii_[i], 0));
+        spindles_[i]->SetAngVelParent(omega + spin);
+    }
+}
+
+void VehicleLod::Advance(double step, const DriverInputs& inputs) {
+    auto chassis = vehicle_->GetChassisBody();
+    ChVector3d old_pos = chassis->GetPos();
+    ChQuaternion<> old_rot = chassis->GetRot();
+
+    // Kinematic bicycle about the rear axle
+    double accel = inputs.m_throttle * settings_.maxAcceleration - inputs.m_braking * settings_.maxDeceleration;
+    if (inputs.m_throttle <= 0) {
+        accel -= settings_.rollingResistance;
+    }
+    speed_ = std::min(std::max(speed_ + accel * step, 0.0), settings_.maxSpeed);
+    yaw_rate_ = speed_ / wheelbase_ * std::tan(inputs.m_steering * settings_.maxSteeringAngle);
+    yaw_ += yaw_rate_ * step;
+    x_ += speed_ * std::cos(yaw_) * step;
+    y_ += speed_ * std::sin(yaw_) * step;
+
+    ChVector3d new_pos(x_, y_, 0);
+    new_pos.z() = terrain_->GetHeight(new_pos) + ride_height_;
+    ChQuaternion<> new_rot = SurfaceRotation(new_pos, yaw_) * attitude_offset_;
+
+    // Move every body rigidly with the chassis
+    MoveBodies(bodies_, old_pos, old_rot, new_pos, new_rot);
+    ChVector3d velocity = (new_pos - old_pos) / step;
+    for (auto& body : bodies_) {
+        // Fixed bodies keep the velocity they are given; drivers and sensors read it
+        body->SetPosDt(velocity);
+        body->SetAngVelParent(ChVector3d(0, 0, yaw_rate_));
+    }
+}
+
+void VehicleLod::MoveBodies(const std::vector<std::shared_ptr<ChBody>>& bodies,
+                            const ChVector3d& ref_pos, const ChQuaternion<>& ref_rot,
+                            const ChVector3d& new_pos, const ChQuaternion<>& new_rot) {
+    ChQuaternion<> delta = new_rot * ref_rot.GetConjugate();
+    for (auto& body : bodies) {
+        body->SetPos(new_pos + delta.Rotate(body->GetPos() - ref_pos));
+        body->SetRot(delta * body->GetRot());
+    }
+}
+
+void VehicleLod::UpdateIdle(double step, const DriverInputs& inputs) {
+    double speed = reduced_ ? speed_ : vehicle_->GetSpeed();
+    if (std::abs(speed) < 0.05 && inputs.m_throttle <= 0) {
+        idle_time_ += step;
+    } else {
+        idle_time_ = 0;
+    }
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "chrono/physics/ChBody.h"
+#include "chrono_vehicle/ChDriver.h"
+#include "chrono_vehicle/ChTerrain.h"
+#include "chrono_vehicle/wheeled_vehicle/ChWheeledVehicle.h"
+
+// Level of detail for one vehicle. In reduced mode every body of the vehicle is fixed, so the
+// solver skips it, and a kinematic bicycle model driven by the same driver inputs moves the
+// whole multibody rigidly over the terrain surface. Promotion releases the bodies with
+// velocities matching the bicycle state, so the full model continues where the reduced one left.
+class VehicleLod {
+public:
+    struct Settings {
+        double promoteRadius;      // Distance (m) to the primary vehicle below which a vehicle is full
+        double demoteRadius;       // Distance (m) beyond which it is reduced again (> promoteRadius)
+        double interactionRadius;  // A vehicle this close (m) to another full vehicle is always full
+        double idleTime;           // Reduce a vehicle standing still this long (s), 0 = never
+        double maxAcceleration;    // Bicycle model longitudinal limits (m/s^2)
+        double maxDeceleration;
+        double maxSpeed;           // (m/s)
+        double maxSteeringAngle;   // Front wheel angle at full steering input (rad)
+        double rollingResistance;  // Deceleration (m/s^2) with no throttle
+
+        Settings();
+    };
+
+    VehicleLod(chrono::vehicle::ChWheeledVehicle* vehicle,
+               const std::vector<std::shared_ptr<chrono::ChBody>>& bodies,
+               std::shared_ptr<chrono::vehicle::ChTerrain> terrain,
+               const Settings& settings = Settings());
+
+    bool IsReduced() const { return reduced_; }
+    const Settings& GetSettings() const { return settings_; }
+
+    // Switch to the bicycle model, starting from the current chassis state
+    void Demote();
+
+    // Release the bodies with velocities taken from the bicycle state
+    void Promote();
+
+    // Reduced mode: integrate the bicycle model and move the bodies along
+    void Advance(double step, const chrono::vehicle::DriverInputs& inputs);
+
+    // Re-read the bicycle state from the bodies (after a snapshot restore)
+    void SyncFromChassis();
+
+    // Time the vehicle has been standing still (either mode)
+    double GetIdleTime() const { return idle_time_; }
+    void UpdateIdle(double step, const chrono::vehicle::DriverInputs& inputs);
+
+    // Move a set of bodies rigidly so that the reference frame (ref_pos, ref_rot) lands on
+    // (new_pos, new_rot); velocities are left untouched
+    static void MoveBodies(const std::vector<std::shared_ptr<chrono::ChBody>>& bodies,
+                           const chrono::ChVector3d& ref_pos, const chrono::ChQuaternion<>& ref_rot,
+                           const chrono::ChVector3d& new_pos, const chrono::ChQuaternion<>& new_rot);
+
+private:
+    // Terrain-following chassis rotation for a heading
+    chrono::ChQuaternion<> SurfaceRotation(const chrono::ChVector3d& pos, double yaw) const;
+    void SetFixed(bool fixed);
+
+    chrono::vehicle::ChWheeledVehicle* vehicle_;
+    std::vector<std::shared_ptr<chrono::ChBody>> bodies_;
+    std::vector<std::shared_ptr<chrono::ChBody>> spindles_;
+    std::vector<double> wheel_radii_;
+    std::shared_ptr<chrono::vehicle::ChTerrain> terrain_;
+    Settings settings_;
+
+    bool reduced_;
+    double wheelbase_;
+    double idle_time_;
+
+    // Bicycle state; the chassis keeps its height above the surface and its attitude
+    // relative to the surface frame from the moment of demotion
+    double x_, y_, yaw_, speed_, yaw_rate_;
+    double ride_height_;
+    chrono::ChQuaternion<> attitude_offset_;
+};
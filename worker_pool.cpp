@@ -0,0 +1,88 @@
+#include "worker_pool.hpp"
+#include "thread_budget.hpp"
+
+WorkerPool::WorkerPool(int num_threads)
+    : generation_(0), busy_(0), stop_(false), fn_(nullptr), next_(0), end_(0) {
+    // The calling thread takes part in every ParallelFor, so it counts as one of the threads
+    for (int i = 1; i < num_threads; i++) {
+        workers_.emplace_back(&WorkerPool::WorkerLoop, this);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    start_cv_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+void WorkerPool::ParallelFor(int begin, int end, const std::function<void(int)>& fn) {
+    if (end - begin <= 1 || workers_.empty()) {
+        for (int i = begin; i < end; i++) {
+            fn(i);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        fn_ = &fn;
+        next_ = begin;
+        end_ = end;
+        busy_ = (int)workers_.size();
+        generation_++;
+    }
+    start_cv_.notify_all();
+
+    RunIndices();
+
+    std::exception_ptr error;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_cv_.wait(lock, [this] { return busy_ == 0; });
+        fn_ = nullptr;
+        std::swap(error, error_);
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void WorkerPool::RunIndices() {
+    // An exception must not leave a worker thread, nor end the caller's share before the workers are done
+    for (int i = next_++; i < end_; i = next_++) {
+        try {
+            (*fn_)(i);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!error_) {
+                error_ = std::current_exception();
+            }
+        }
+    }
+}
+
+void WorkerPool::WorkerLoop() {
+    ThreadBudget::PinCurrentThread(ThreadBudget::Role::PHYSICS);
+
+    uint64_t seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            start_cv_.wait(lock, [&] { return stop_ || generation_ != seen; });
+            if (stop_) return;
+            seen = generation_;
+        }
+
+        RunIndices();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--busy_ == 0) {
+            done_cv_.notify_one();
+        }
+    }
+}
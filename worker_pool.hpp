@@ -0,0 +1,41 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Small fork-join pool for per-vehicle work on the physics thread. ParallelFor() hands the
+// indices out to the workers and the calling thread and returns once all of them are done.
+// Workers are pinned to the physics CPUs of the thread budget.
+class WorkerPool {
+public:
+    explicit WorkerPool(int num_threads);
+    ~WorkerPool();
+
+    int GetNumThreads() const { return (int)workers_.size() + 1; }
+
+    // Run fn(i) for i in [begin, end); not reentrant. If fn throws, the remaining indices still
+    // run and the first exception is rethrown on the calling thread.
+    void ParallelFor(int begin, int end, const std::function<void(int)>& fn);
+
+private:
+    void WorkerLoop();
+    void RunIndices();
+
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable start_cv_;
+    std::condition_variable done_cv_;
+    uint64_t generation_;
+    int busy_;
+    bool stop_;
+
+    const std::function<void(int)>* fn_;
+    std::atomic<int> next_;
+    int end_;
+    std::exception_ptr error_;  // First exception thrown by fn_ in the current ParallelFor
+};